@@ -0,0 +1,104 @@
+#include "Snapshot.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// Compares ways of handing a hot-reloaded configuration var to many reader threads:
+// a mutex-guarded shared_ptr, std::atomic<std::shared_ptr>, and SnapshotPublisher.
+
+namespace {
+    constexpr int kReloads = 200;
+    constexpr auto kRunTime = std::chrono::milliseconds(500);
+
+    var makeConfig(int version) {
+        TableBuilder builder(16);
+        builder.set("version", var(version));
+        for (int i = 0; i < 15; ++i) {
+            builder.set("setting" + std::to_string(i), var(i * version));
+        }
+        return builder.build();
+    }
+
+    // Runs readers until the time is up while one writer keeps publishing; returns reads per second
+    template <typename ReadFn, typename PublishFn, typename ThreadInit>
+    double run(unsigned threads, ThreadInit threadInit, ReadFn read, PublishFn publish) {
+        std::atomic<bool> stop{ false };
+        std::atomic<long long> totalReads{ 0 };
+        std::vector<std::thread> readers;
+        for (unsigned t = 0; t < threads; ++t) {
+            readers.emplace_back([&] {
+                auto state = threadInit();
+                long long reads = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    read(state);
+                    ++reads;
+                }
+                totalReads += reads;
+                });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int version = 1; std::chrono::steady_clock::now() - start < kRunTime; ++version) {
+            publish(makeConfig(version));
+            std::this_thread::sleep_for(kRunTime / kReloads);
+        }
+        stop = true;
+        for (auto& reader : readers) reader.join();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return static_cast<double>(totalReads.load()) / seconds;
+    }
+
+    // Touches the configuration the way a request handler would
+    void useConfig(const var& config) {
+        if (var::len(config) == 0) std::abort();
+    }
+}
+
+int main() {
+    unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+    std::cout << "Readers: " << threads << std::endl;
+
+    {
+        std::mutex mutex;
+        std::shared_ptr<const var> config = std::make_shared<const var>(makeConfig(0));
+        double rate = run(threads, [] { return 0; },
+            [&](int) {
+                std::shared_ptr<const var> snapshot;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    snapshot = config;
+                }
+                useConfig(*snapshot);
+            },
+            [&](var next) {
+                auto fresh = std::make_shared<const var>(std::move(next));
+                std::lock_guard<std::mutex> lock(mutex);
+                config = std::move(fresh);
+            });
+        std::cout << "mutex + shared_ptr:        " << rate / 1e6 << " M reads/s" << std::endl;
+    }
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+    {
+        std::atomic<std::shared_ptr<const var>> config{ std::make_shared<const var>(makeConfig(0)) };
+        double rate = run(threads, [] { return 0; },
+            [&](int) { useConfig(*config.load()); },
+            [&](var next) { config.store(std::make_shared<const var>(std::move(next))); });
+        std::cout << "atomic<shared_ptr>:        " << rate / 1e6 << " M reads/s" << std::endl;
+    }
+#else
+    std::cout << "atomic<shared_ptr>:        not supported by this standard library" << std::endl;
+#endif
+
+    {
+        SnapshotPublisher config(makeConfig(0));
+        double rate = run(threads, [&] { return config.reader(); },
+            [](SnapshotPublisher::Reader& reader) { useConfig(*reader.read()); },
+            [&](var next) { config.publish(std::move(next)); });
+        std::cout << "SnapshotPublisher:         " << rate / 1e6 << " M reads/s" << std::endl;
+    }
+
+    return 0;
+}
@@ -1,4 +1,4 @@
-#include "HighCpp.h"
+#include "HighCPP.h"
 #include <cassert>
 
 // A sample custom class to store in std::any
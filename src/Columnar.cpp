@@ -0,0 +1,357 @@
+#include "Columnar.h"
+
+#include <algorithm>
+
+// ------------------------ Column ------------------------
+
+Column::Column(ColumnType type) : type_(type) {
+    switch (type) {
+    case ColumnType::Int: data_.emplace<std::vector<int>>(); break;
+    case ColumnType::Double: data_.emplace<std::vector<double>>(); break;
+    case ColumnType::String: data_.emplace<std::vector<VarString>>(); break;
+    case ColumnType::Mixed: data_.emplace<std::vector<var>>(); break;
+    }
+}
+
+var Column::get(size_t row) const {
+    if (row >= size_) throw std::out_of_range("Row out of range");
+    if (isNull(row)) return var();
+    switch (type_) {
+    case ColumnType::Int: return var(ints()[row]);
+    case ColumnType::Double: return var(doubles()[row]);
+    case ColumnType::String: return var(strings()[row]);
+    default: return values()[row];
+    }
+}
+
+void Column::reserve(size_t count) {
+    std::visit([count](auto& cells) { cells.reserve(count); }, data_);
+    validity_.reserve((count + 63) / 64);
+}
+
+void Column::resize(size_t count) {
+    // Clear the bits of dropped cells so that growing again yields nulls
+    for (size_t row = count; row < size_; ++row) {
+        if (isNull(row)) --nullCount_;
+        else setValid(row, false);
+    }
+    std::visit([count](auto& cells) { cells.resize(count); }, data_);
+    validity_.resize((count + 63) / 64, 0);
+    if (count > size_) nullCount_ += count - size_;
+    size_ = count;
+}
+
+bool Column::accepts(const var& value) const {
+    if (value.isNull()) return true;
+    switch (type_) {
+    case ColumnType::Int: return value.isInt();
+    case ColumnType::Double: return value.isNumber();
+    case ColumnType::String: return value.isString();
+    default: return true;
+    }
+}
+
+// The type is checked first, so a rejected value does not leave a null cell behind
+void Column::append(const var& value) {
+    if (!accepts(value)) throw std::bad_variant_access();
+    resize(size_ + 1);
+    set(size_ - 1, value);
+}
+
+void Column::append(var&& value) {
+    if (!accepts(value)) throw std::bad_variant_access();
+    resize(size_ + 1);
+    set(size_ - 1, std::move(value));
+}
+
+void Column::appendNull() {
+    resize(size_ + 1);
+}
+
+// Moving a String or Mixed cell in avoids copying its contents
+template <typename Value>
+void Column::assign(size_t row, Value&& value) {
+    if (row >= size_) throw std::out_of_range("Row out of range");
+    if (value.isNull()) {
+        if (!isNull(row)) {
+            setValid(row, false);
+            ++nullCount_;
+        }
+        return;
+    }
+
+    switch (type_) {
+    case ColumnType::Int:
+        std::get<std::vector<int>>(data_)[row] = value.getInt();
+        break;
+    case ColumnType::Double:
+        std::get<std::vector<double>>(data_)[row] = value.toDouble();
+        break;
+    case ColumnType::String:
+        // Shares the string's buffer; no characters are copied
+        std::get<std::vector<VarString>>(data_)[row] = value.getString();
+        break;
+    case ColumnType::Mixed:
+        std::get<std::vector<var>>(data_)[row] = std::forward<Value>(value);
+        break;
+    }
+    if (isNull(row)) {
+        setValid(row, true);
+        --nullCount_;
+    }
+}
+
+void Column::set(size_t row, const var& value) {
+    assign(row, value);
+}
+
+void Column::set(size_t row, var&& value) {
+    assign(row, std::move(value));
+}
+
+void Column::extend(Column&& other) {
+    if (other.type_ != type_) throw std::invalid_argument("Column types do not match");
+    size_t offset = size_;
+    std::visit([&](auto& cells) {
+        auto& source = std::get<std::decay_t<decltype(cells)>>(other.data_);
+        cells.insert(cells.end(), std::make_move_iterator(source.begin()), std::make_move_iterator(source.end()));
+        }, data_);
+    size_ += other.size_;
+    validity_.resize((size_ + 63) / 64, 0);
+    for (size_t row = 0; row < other.size_; ++row) {
+        if (!other.isNull(row)) setValid(offset + row, true);
+    }
+    nullCount_ += other.nullCount_;
+    other = Column(type_);
+}
+
+void Column::setValid(size_t row, bool valid) {
+    uint64_t bit = uint64_t(1) << (row & 63);
+    if (valid) validity_[row >> 6] |= bit;
+    else validity_[row >> 6] &= ~bit;
+}
+
+// ------------------------ ColumnarTable ------------------------
+
+bool ColumnarTable::hasColumn(const std::string& name) const {
+    return lookup_.find(name) != lookup_.end();
+}
+
+const Column& ColumnarTable::column(const std::string& name) const {
+    return columns_[indexOf(name)];
+}
+
+size_t ColumnarTable::indexOf(const std::string& name) const {
+    auto it = lookup_.find(name);
+    if (it == lookup_.end()) throw std::out_of_range("Column not found");
+    return it->second;
+}
+
+void ColumnarTable::addColumn(std::string name, Column column) {
+    if (hasColumn(name)) throw std::invalid_argument("Duplicate column name");
+    if (columns_.empty()) rowCount_ = column.size();
+    else if (column.size() != rowCount_) throw std::invalid_argument("Column length does not match row count");
+    lookup_.emplace(name, columns_.size());
+    names_.emplace_back(std::move(name));
+    columns_.emplace_back(std::move(column));
+}
+
+size_t ColumnarTable::count(const std::string& name) const {
+    const Column& col = column(name);
+    return col.size() - col.nullCount();
+}
+
+namespace {
+    // Calls fn on every non-null numeric cell; the common no-null case is a plain loop
+    template <typename Cell, typename Fn>
+    void forEachPresent(const Column& col, const std::vector<Cell>& cells, Fn&& fn) {
+        if (col.nullCount() == 0) {
+            for (const Cell& cell : cells) fn(cell);
+            return;
+        }
+        for (size_t row = 0; row < cells.size(); ++row) {
+            if (!col.isNull(row)) fn(cells[row]);
+        }
+    }
+
+    void requireNumeric(const Column& col) {
+        if (col.type() != ColumnType::Int && col.type() != ColumnType::Double) {
+            throw std::runtime_error("Column is not numeric");
+        }
+    }
+}
+
+double ColumnarTable::sum(const std::string& name) const {
+    const Column& col = column(name);
+    requireNumeric(col);
+    if (col.type() == ColumnType::Int) {
+        long long total = 0;
+        forEachPresent(col, col.ints(), [&](int cell) { total += cell; });
+        return static_cast<double>(total);
+    }
+    double total = 0.0;
+    forEachPresent(col, col.doubles(), [&](double cell) { total += cell; });
+    return total;
+}
+
+double ColumnarTable::mean(const std::string& name) const {
+    size_t present = count(name);
+    if (present == 0) throw std::runtime_error("Column has no values");
+    return sum(name) / static_cast<double>(present);
+}
+
+var ColumnarTable::min(const std::string& name) const {
+    const Column& col = column(name);
+    requireNumeric(col);
+    if (col.size() == col.nullCount()) return var();
+    if (col.type() == ColumnType::Int) {
+        int best = std::numeric_limits<int>::max();
+        forEachPresent(col, col.ints(), [&](int cell) { best = std::min(best, cell); });
+        return var(best);
+    }
+    double best = std::numeric_limits<double>::infinity();
+    forEachPresent(col, col.doubles(), [&](double cell) { best = std::min(best, cell); });
+    return var(best);
+}
+
+var ColumnarTable::max(const std::string& name) const {
+    const Column& col = column(name);
+    requireNumeric(col);
+    if (col.size() == col.nullCount()) return var();
+    if (col.type() == ColumnType::Int) {
+        int best = std::numeric_limits<int>::lowest();
+        forEachPresent(col, col.ints(), [&](int cell) { best = std::max(best, cell); });
+        return var(best);
+    }
+    double best = -std::numeric_limits<double>::infinity();
+    forEachPresent(col, col.doubles(), [&](double cell) { best = std::max(best, cell); });
+    return var(best);
+}
+
+ColumnarTable ColumnarTable::take(const std::vector<size_t>& rows) const {
+    ColumnarTable result;
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        const Column& source = columns_[c];
+        Column picked(source.type());
+        picked.resize(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            if (rows[i] >= rowCount_) throw std::out_of_range("Row out of range");
+            if (!source.isNull(rows[i])) picked.set(i, source.get(rows[i]));
+        }
+        result.addColumn(names_[c], std::move(picked));
+    }
+    if (columns_.empty()) result.rowCount_ = rows.size();
+    return result;
+}
+
+var ColumnarTable::toRows(RowKind kind) const {
+    Array rows(rowCount_);
+    for (size_t row = 0; row < rowCount_; ++row) {
+        if (kind == RowKind::OrderedTable) {
+            OrderedTable tbl;
+            tbl.reserve(columns_.size());
+            for (size_t c = 0; c < columns_.size(); ++c) {
+                if (!columns_[c].isNull(row)) tbl.insert_or_assign(names_[c], columns_[c].get(row));
+            }
+            rows[row] = var(std::move(tbl));
+        }
+        else if (kind == RowKind::Record) {
+            // Rows with the same null pattern share a shape through its transitions
+            Record rec;
+            for (size_t c = 0; c < columns_.size(); ++c) {
+                if (!columns_[c].isNull(row)) rec.insert_or_assign(names_[c], columns_[c].get(row));
+            }
+            rows[row] = var(std::move(rec));
+        }
+        else {
+            Table tbl;
+            tbl.reserve(columns_.size());
+            for (size_t c = 0; c < columns_.size(); ++c) {
+                if (!columns_[c].isNull(row)) tbl.emplace(names_[c], columns_[c].get(row));
+            }
+            rows[row] = var(std::move(tbl));
+        }
+    }
+    return var(std::move(rows));
+}
+
+// ------------------------ Row to Column Conversion ------------------------
+
+namespace {
+    // Bits recording which value types were seen in a column
+    enum SeenType : unsigned {
+        SeenInt = 1,
+        SeenDouble = 2,
+        SeenString = 4,
+        SeenOther = 8
+    };
+
+    unsigned seenTypeOf(const var& value) {
+        if (value.isInt()) return SeenInt;
+        if (value.isDouble()) return SeenDouble;
+        if (value.isString()) return SeenString;
+        if (value.isNull()) return 0;
+        return SeenOther;
+    }
+
+    ColumnType columnTypeFor(unsigned seen) {
+        switch (seen) {
+        case SeenInt: return ColumnType::Int;
+        case SeenDouble:
+        case SeenInt | SeenDouble: return ColumnType::Double;
+        case SeenString: return ColumnType::String;
+        default: return ColumnType::Mixed;
+        }
+    }
+}
+
+ColumnarTable var::toColumnar(const var& rows) {
+    if (!rows.isArray()) throw std::runtime_error("var is not an Array");
+    const Array& rowArray = rows.getArray();
+
+    // First pass: discover columns in first-seen order and infer their types
+    std::vector<std::string> names;
+    std::vector<unsigned> seen;
+    std::unordered_map<std::string_view, size_t> lookup; // Views of keys owned by rows
+    for (const var& row : rowArray) {
+        row.forEachEntry([&](std::string_view key, const var& value) {
+            auto [it, inserted] = lookup.try_emplace(key, names.size());
+            if (inserted) {
+                names.emplace_back(key);
+                seen.push_back(0);
+            }
+            seen[it->second] |= seenTypeOf(value);
+            });
+    }
+
+    // Second pass: scatter cells into their packed columns
+    std::vector<Column> columns;
+    columns.reserve(names.size());
+    for (unsigned bits : seen) {
+        columns.emplace_back(columnTypeFor(bits));
+        columns.back().resize(rowArray.size());
+    }
+    for (size_t row = 0; row < rowArray.size(); ++row) {
+        rowArray[row].forEachEntry([&](std::string_view key, const var& value) {
+            columns[lookup.find(key)->second].set(row, value);
+            });
+    }
+
+    ColumnarTable result;
+    for (size_t c = 0; c < names.size(); ++c) {
+        result.addColumn(std::move(names[c]), std::move(columns[c]));
+    }
+    return result;
+}
+
+var var::fromColumnar(const ColumnarTable& columns, RowKind kind) {
+    return columns.toRows(kind);
+}
+
+ColumnarTable toColumnar(const var& rows) {
+    return var::toColumnar(rows);
+}
+
+var fromColumnar(const ColumnarTable& columns, RowKind kind) {
+    return var::fromColumnar(columns, kind);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "HighCPP.h"
+
+#include <limits>
+
+// Storage type of a Column; Mixed keeps boxed vars for heterogeneous data
+enum class ColumnType {
+    Int,
+    Double,
+    String,
+    Mixed
+};
+
+// Row container produced when converting columnar data back to rows
+enum class RowKind {
+    Table,
+    OrderedTable,
+    Record
+};
+
+// A packed column of cells. Values live in one contiguous typed vector and a
+// validity bitmap marks which cells are present (a cleared bit is a null).
+class Column {
+public:
+    explicit Column(ColumnType type = ColumnType::Mixed);
+
+    ColumnType type() const { return type_; }
+    size_t size() const { return size_; }
+    size_t nullCount() const { return nullCount_; }
+    bool isNull(size_t row) const { return (validity_[row >> 6] & (uint64_t(1) << (row & 63))) == 0; }
+
+    // Packed storage; throws std::bad_variant_access if the column has another type.
+    // Null cells hold a default value (0, 0.0, "" or Null).
+    const std::vector<int>& ints() const { return std::get<std::vector<int>>(data_); }
+    const std::vector<double>& doubles() const { return std::get<std::vector<double>>(data_); }
+    const std::vector<VarString>& strings() const { return std::get<std::vector<VarString>>(data_); }
+    const std::vector<var>& values() const { return std::get<std::vector<var>>(data_); }
+    const std::vector<uint64_t>& validity() const { return validity_; }
+
+    // Boxes a single cell; null cells become Null vars
+    var get(size_t row) const;
+
+    void reserve(size_t count);
+    void resize(size_t count); // New cells are null
+
+    // Cells must match the column type (or be Null); Double columns also take
+    // Ints, stored as doubles, and Mixed columns accept anything. Other values
+    // throw std::bad_variant_access and leave the column unchanged.
+    bool accepts(const var& value) const;
+    void append(const var& value);
+    void append(var&& value);
+    void appendNull();
+    void set(size_t row, const var& value);
+    void set(size_t row, var&& value);
+
+    // Moves all cells of other (which must have the same type) onto the end
+    void extend(Column&& other);
+
+private:
+    template <typename Value>
+    void assign(size_t row, Value&& value);
+    void setValid(size_t row, bool valid);
+
+    ColumnType type_;
+    std::variant<std::vector<int>, std::vector<double>, std::vector<VarString>, std::vector<var>> data_;
+    std::vector<uint64_t> validity_;
+    size_t size_ = 0;
+    size_t nullCount_ = 0;
+};
+
+// Struct-of-arrays view of an Array of row Tables: one Column per key, all the
+// same length. Built with var::toColumnar and turned back into rows with toRows.
+// A key whose values are all Ints becomes an Int column, Ints mixed with Doubles
+// a Double column, all Strings a String column, and anything else Mixed.
+// Missing keys and Null values are null cells.
+class ColumnarTable {
+public:
+    size_t rowCount() const { return rowCount_; }
+    size_t columnCount() const { return columns_.size(); }
+    const std::vector<std::string>& columnNames() const { return names_; }
+    bool hasColumn(const std::string& name) const;
+    const Column& column(const std::string& name) const;
+    const Column& column(size_t index) const { return columns_[index]; }
+
+    // The first column fixes the row count; later ones must match it
+    void addColumn(std::string name, Column column);
+
+    // Aggregates over Int and Double columns; nulls are skipped
+    size_t count(const std::string& name) const;
+    double sum(const std::string& name) const;
+    double mean(const std::string& name) const;
+    var min(const std::string& name) const;
+    var max(const std::string& name) const;
+
+    // Returns the rows whose non-null cell satisfies predicate. The predicate is
+    // called with int, double, const VarString& or const var& depending on the
+    // column type; a predicate that cannot take that type throws.
+    template <typename Predicate>
+    std::vector<size_t> where(const std::string& name, Predicate predicate) const;
+
+    // Keeps only the given rows, in the given order
+    ColumnarTable take(const std::vector<size_t>& rows) const;
+
+    // Converts back to an Array of rows; null cells are left out of their row
+    var toRows(RowKind kind = RowKind::Table) const;
+
+private:
+    size_t indexOf(const std::string& name) const;
+
+    std::vector<std::string> names_;
+    std::vector<Column> columns_;
+    std::unordered_map<std::string, size_t> lookup_;
+    size_t rowCount_ = 0;
+};
+
+template <typename Predicate>
+std::vector<size_t> ColumnarTable::where(const std::string& name, Predicate predicate) const {
+    const Column& col = column(name);
+    std::vector<size_t> rows;
+
+    auto scan = [&](const auto& cells) {
+        using Cell = typename std::decay_t<decltype(cells)>::value_type;
+        if constexpr (std::is_invocable_r_v<bool, Predicate&, const Cell&>) {
+            for (size_t row = 0; row < cells.size(); ++row) {
+                if (!col.isNull(row) && predicate(cells[row])) rows.push_back(row);
+            }
+        }
+        else {
+            throw std::runtime_error("Predicate does not accept the column type");
+        }
+    };
+
+    switch (col.type()) {
+    case ColumnType::Int: scan(col.ints()); break;
+    case ColumnType::Double: scan(col.doubles()); break;
+    case ColumnType::String: scan(col.strings()); break;
+    case ColumnType::Mixed: scan(col.values()); break;
+    }
+    return rows;
+}
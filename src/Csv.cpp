@@ -0,0 +1,485 @@
+#include "Csv.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ------------------------ File Access ------------------------
+
+namespace {
+    // Read-only view of a whole file: memory-mapped on POSIX, read into memory elsewhere
+    class FileView {
+    public:
+        explicit FileView(const std::string& path) {
+#ifdef _WIN32
+            std::ifstream in(path, std::ios::binary);
+            if (!in) throw std::runtime_error("Cannot open file: " + path);
+            buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error("Cannot open file: " + path);
+            struct stat info;
+            if (::fstat(fd, &info) != 0) {
+                ::close(fd);
+                throw std::runtime_error("Cannot read file: " + path);
+            }
+            size_ = static_cast<size_t>(info.st_size);
+            if (size_ > 0) {
+                void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error("Cannot map file: " + path);
+                }
+                ::madvise(mapping, size_, MADV_SEQUENTIAL);
+                data_ = static_cast<const char*>(mapping);
+            }
+            ::close(fd);
+#endif
+        }
+
+        ~FileView() {
+#ifndef _WIN32
+            if (data_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+        }
+
+        FileView(const FileView&) = delete;
+        FileView& operator=(const FileView&) = delete;
+
+        std::string_view text() const { return { data_, size_ }; }
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        std::string buffer_;
+#endif
+    };
+}
+
+// ------------------------ Tokenizer ------------------------
+
+namespace {
+    struct CsvField {
+        std::string_view text;
+        bool quoted;
+    };
+
+    // Splits text into rows of fields. Fields borrow from text except quoted
+    // fields with doubled quotes, which are unescaped into reader-owned storage.
+    class CsvReader {
+    public:
+        CsvReader(std::string_view text, const CsvOptions& options)
+            : text_(text), delimiter_(options.delimiter), quote_(options.quote) {}
+
+        size_t position() const { return pos_; }
+
+        // Reads the next non-blank row; false at the end of the text
+        bool next(std::vector<CsvField>& fields) {
+            fields.clear();
+            unescaped_.clear();
+            skipBlankLines();
+            if (pos_ >= text_.size()) return false;
+
+            while (true) {
+                fields.push_back(text_[pos_] == quote_ ? readQuoted() : readPlain());
+                if (pos_ >= text_.size()) return true;
+                char c = text_[pos_++];
+                if (c == delimiter_) {
+                    if (pos_ >= text_.size()) {
+                        fields.push_back({ {}, false });
+                        return true;
+                    }
+                    continue;
+                }
+                if (c == '\r' && pos_ < text_.size() && text_[pos_] == '\n') ++pos_;
+                return true;
+            }
+        }
+
+    private:
+        void skipBlankLines() {
+            while (pos_ < text_.size()) {
+                if (text_[pos_] == '\n') ++pos_;
+                else if (text_[pos_] == '\r' && pos_ + 1 < text_.size() && text_[pos_ + 1] == '\n') pos_ += 2;
+                else break;
+            }
+        }
+
+        CsvField readPlain() {
+            size_t start = pos_;
+            while (pos_ < text_.size()) {
+                char c = text_[pos_];
+                if (c == delimiter_ || c == '\n') break;
+                if (c == '\r' && pos_ + 1 < text_.size() && text_[pos_ + 1] == '\n') break;
+                ++pos_;
+            }
+            return { text_.substr(start, pos_ - start), false };
+        }
+
+        CsvField readQuoted() {
+            size_t start = ++pos_;
+            bool escaped = false;
+            while (true) {
+                size_t close = text_.find(quote_, pos_);
+                if (close == std::string_view::npos) throw std::runtime_error("Unterminated quoted CSV field");
+                if (close + 1 < text_.size() && text_[close + 1] == quote_) {
+                    escaped = true;
+                    pos_ = close + 2;
+                    continue;
+                }
+                pos_ = close + 1;
+                break;
+            }
+
+            size_t end = pos_ - 1;
+            if (pos_ < text_.size()) {
+                char c = text_[pos_];
+                if (c != delimiter_ && c != '\n' && c != '\r') throw std::runtime_error("Unexpected character after quoted CSV field");
+            }
+            std::string_view raw = text_.substr(start, end - start);
+            if (!escaped) return { raw, true };
+
+            std::string& unescaped = unescaped_.emplace_back();
+            unescaped.reserve(raw.size());
+            for (size_t i = 0; i < raw.size(); ++i) {
+                unescaped.push_back(raw[i]);
+                if (raw[i] == quote_) ++i;
+            }
+            return { unescaped, true };
+        }
+
+        std::string_view text_;
+        size_t pos_ = 0;
+        char delimiter_;
+        char quote_;
+        std::deque<std::string> unescaped_;  // Stable addresses while a row's fields are in use
+    };
+
+    // Bits recording which cell types were seen in a column
+    enum SeenType : unsigned {
+        SeenInt = 1,
+        SeenDouble = 2,
+        SeenString = 4
+    };
+
+    // from_chars also accepts nan, inf and infinity; those cells are text
+    bool startsLikeNumber(std::string_view text) {
+        auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+        size_t i = text[0] == '-' ? 1 : 0;
+        return i < text.size() && (isDigit(text[i]) || text[i] == '.');
+    }
+
+    unsigned seenTypeOf(const CsvField& field) {
+        if (field.quoted) return SeenString;
+        if (field.text.empty()) return 0;
+        if (!startsLikeNumber(field.text)) return SeenString;
+        const char* first = field.text.data();
+        const char* last = first + field.text.size();
+        int i;
+        auto intResult = std::from_chars(first, last, i);
+        if (intResult.ec == std::errc() && intResult.ptr == last) return SeenInt;
+        double d;
+        auto doubleResult = std::from_chars(first, last, d);
+        if (doubleResult.ec == std::errc() && doubleResult.ptr == last) return SeenDouble;
+        return SeenString;
+    }
+
+    var typedCell(const CsvField& field) {
+        if (field.quoted) return var(field.text);
+        if (field.text.empty()) return var();
+        if (!startsLikeNumber(field.text)) return var(field.text);
+        const char* first = field.text.data();
+        const char* last = first + field.text.size();
+        int i;
+        auto intResult = std::from_chars(first, last, i);
+        if (intResult.ec == std::errc() && intResult.ptr == last) return var(i);
+        double d;
+        auto doubleResult = std::from_chars(first, last, d);
+        if (doubleResult.ec == std::errc() && doubleResult.ptr == last) return var(d);
+        return var(field.text);
+    }
+
+    // Converts a cell for a column whose type is already known
+    var columnCell(const CsvField& field, ColumnType type) {
+        if (field.text.empty() && !field.quoted) return var();
+        const char* first = field.text.data();
+        const char* last = first + field.text.size();
+        switch (type) {
+        case ColumnType::Int: {
+            int i = 0;
+            std::from_chars(first, last, i);
+            return var(i);
+        }
+        case ColumnType::Double: {
+            double d = 0.0;
+            std::from_chars(first, last, d);
+            return var(d);
+        }
+        default:
+            return var(field.text);
+        }
+    }
+}
+
+// ------------------------ Chunking ------------------------
+
+namespace {
+    size_t workerCount(const CsvOptions& options) {
+        if (options.threads) return options.threads;
+        return std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // Runs task(i) for every i < count on up to threads threads and rethrows
+    // the exception of the lowest failing task
+    template <typename Task>
+    void runParallel(size_t count, size_t threads, Task&& task) {
+        std::vector<std::exception_ptr> errors(count);
+        std::atomic<size_t> nextTask{ 0 };
+        auto work = [&] {
+            for (size_t i = nextTask++; i < count; i = nextTask++) {
+                try {
+                    task(i);
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < std::min(threads, count); ++t) workers.emplace_back(work);
+        work();
+        for (std::thread& worker : workers) worker.join();
+        for (const std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+    }
+
+    // Splits body into chunks that each start at the beginning of a row. The
+    // parity of the quote count before each nominal split point (a parallel
+    // count plus a prefix sum) tells whether that point lies inside a quoted
+    // field; the chunk then starts after the next newline outside quotes.
+    std::vector<std::string_view> splitRows(std::string_view body, const CsvOptions& options, size_t threads) {
+        size_t count = std::max<size_t>(1, body.size() / std::max<size_t>(1, options.chunkSize));
+        if (count == 1) return { body };
+
+        std::vector<size_t> starts(count + 1);
+        for (size_t i = 0; i <= count; ++i) starts[i] = body.size() * i / count;
+
+        std::vector<unsigned char> oddQuotes(count);
+        runParallel(count, threads, [&](size_t i) {
+            oddQuotes[i] = std::count(body.begin() + starts[i], body.begin() + starts[i + 1], options.quote) & 1;
+        });
+
+        std::vector<size_t> boundaries{ 0 };
+        bool inQuotes = false;
+        for (size_t i = 1; i < count; ++i) {
+            inQuotes ^= oddQuotes[i - 1] != 0;
+            bool quoted = inQuotes;
+            size_t pos = starts[i];
+            while (pos < body.size()) {
+                char c = body[pos++];
+                if (c == options.quote) quoted = !quoted;
+                else if (c == '\n' && !quoted) break;
+            }
+            if (pos > boundaries.back()) boundaries.push_back(pos);
+        }
+        if (boundaries.back() < body.size()) boundaries.push_back(body.size());
+
+        std::vector<std::string_view> chunks;
+        for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+            chunks.push_back(body.substr(boundaries[i], boundaries[i + 1] - boundaries[i]));
+        }
+        return chunks;
+    }
+
+    // Reads the column names and returns the text after the header row
+    std::string_view readHeader(std::string_view text, const CsvOptions& options, std::vector<std::string>& names) {
+        CsvReader reader(text, options);
+        std::vector<CsvField> fields;
+        if (!reader.next(fields)) return {};
+
+        if (options.header) {
+            for (const CsvField& field : fields) {
+                std::string name(field.text);
+                if (std::find(names.begin(), names.end(), name) != names.end()) throw std::runtime_error("Duplicate CSV column name: " + name);
+                names.push_back(std::move(name));
+            }
+            return text.substr(reader.position());
+        }
+        for (size_t c = 0; c < fields.size(); ++c) names.push_back("column" + std::to_string(c + 1));
+        return text;
+    }
+
+    void checkWidth(const std::vector<CsvField>& fields, size_t columns) {
+        if (fields.size() > columns) throw std::runtime_error("CSV row has more fields than the header");
+    }
+
+    Array parseRowChunk(std::string_view chunk, const std::vector<std::string>& names,
+        const std::shared_ptr<const Shape>& shape, const CsvOptions& options) {
+        CsvReader reader(chunk, options);
+        std::vector<CsvField> fields;
+        Array rows;
+        // Table rows of a chunk share their key buffers
+        std::vector<VarString> keys(names.begin(), names.end());
+        while (reader.next(fields)) {
+            checkWidth(fields, names.size());
+            auto cell = [&](size_t c) { return c < fields.size() ? typedCell(fields[c]) : var(); };
+
+            if (options.rowKind == RowKind::Record) {
+                Record rec(shape);
+                for (size_t c = 0; c < names.size(); ++c) rec.valueAt(c) = cell(c);
+                rows.emplace_back(std::move(rec));
+            }
+            else if (options.rowKind == RowKind::OrderedTable) {
+                OrderedTable tbl;
+                tbl.reserve(names.size());
+                for (size_t c = 0; c < names.size(); ++c) tbl.insert_or_assign(names[c], cell(c));
+                rows.emplace_back(std::move(tbl));
+            }
+            else {
+                Table tbl;
+                tbl.reserve(names.size());
+                for (size_t c = 0; c < names.size(); ++c) tbl.emplace(keys[c], cell(c));
+                rows.emplace_back(std::move(tbl));
+            }
+        }
+        return rows;
+    }
+
+    ColumnType csvColumnType(unsigned seen) {
+        if (seen & SeenString || seen == 0) return ColumnType::String;
+        if (seen & SeenDouble) return ColumnType::Double;
+        return ColumnType::Int;
+    }
+}
+
+// ------------------------ Entry Points ------------------------
+
+var parseCsv(std::string_view text, const CsvOptions& options) {
+    std::vector<std::string> names;
+    std::string_view body = readHeader(text, options, names);
+    std::shared_ptr<const Shape> shape = options.rowKind == RowKind::Record ? Shape::forKeys(names) : nullptr;
+
+    size_t threads = workerCount(options);
+    std::vector<std::string_view> chunks = splitRows(body, options, threads);
+    std::vector<Array> parts(chunks.size());
+    runParallel(chunks.size(), threads, [&](size_t i) { parts[i] = parseRowChunk(chunks[i], names, shape, options); });
+
+    // Stitch the chunks back together in file order
+    size_t total = 0;
+    for (const Array& part : parts) total += part.size();
+    Array rows;
+    rows.reserve(total);
+    for (Array& part : parts) {
+        rows.insert(rows.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+        part = Array();
+    }
+    return var(std::move(rows));
+}
+
+ColumnarTable parseCsvColumnar(std::string_view text, const CsvOptions& options) {
+    std::vector<std::string> names;
+    std::string_view body = readHeader(text, options, names);
+    size_t threads = workerCount(options);
+    std::vector<std::string_view> chunks = splitRows(body, options, threads);
+
+    // First pass: infer column types per chunk and count rows
+    std::vector<std::vector<unsigned>> seen(chunks.size(), std::vector<unsigned>(names.size(), 0));
+    std::vector<size_t> rowCounts(chunks.size(), 0);
+    runParallel(chunks.size(), threads, [&](size_t i) {
+        CsvReader reader(chunks[i], options);
+        std::vector<CsvField> fields;
+        while (reader.next(fields)) {
+            checkWidth(fields, names.size());
+            for (size_t c = 0; c < fields.size(); ++c) seen[i][c] |= seenTypeOf(fields[c]);
+            ++rowCounts[i];
+        }
+    });
+
+    std::vector<ColumnType> types(names.size());
+    for (size_t c = 0; c < names.size(); ++c) {
+        unsigned bits = 0;
+        for (const auto& chunkSeen : seen) bits |= chunkSeen[c];
+        types[c] = csvColumnType(bits);
+    }
+
+    // Second pass: fill typed columns per chunk
+    std::vector<std::vector<Column>> parts(chunks.size());
+    runParallel(chunks.size(), threads, [&](size_t i) {
+        std::vector<Column>& columns = parts[i];
+        for (ColumnType type : types) {
+            columns.emplace_back(type);
+            columns.back().reserve(rowCounts[i]);
+        }
+        CsvReader reader(chunks[i], options);
+        std::vector<CsvField> fields;
+        while (reader.next(fields)) {
+            for (size_t c = 0; c < names.size(); ++c) {
+                if (c < fields.size()) columns[c].append(columnCell(fields[c], types[c]));
+                else columns[c].appendNull();
+            }
+        }
+    });
+
+    // Stitch the chunks back together in file order
+    size_t total = 0;
+    for (size_t rows : rowCounts) total += rows;
+    ColumnarTable result;
+    for (size_t c = 0; c < names.size(); ++c) {
+        Column column(types[c]);
+        column.reserve(total);
+        for (auto& part : parts) column.extend(std::move(part[c]));
+        result.addColumn(names[c], std::move(column));
+    }
+    return result;
+}
+
+var var::readCsv(const std::string& path) {
+    return readCsv(path, CsvOptions());
+}
+
+var var::readCsv(const std::string& path, const CsvOptions& options) {
+    FileView file(path);
+    return parseCsv(file.text(), options);
+}
+
+ColumnarTable var::readCsvColumnar(const std::string& path) {
+    return readCsvColumnar(path, CsvOptions());
+}
+
+ColumnarTable var::readCsvColumnar(const std::string& path, const CsvOptions& options) {
+    FileView file(path);
+    return parseCsvColumnar(file.text(), options);
+}
+
+var readCsv(const std::string& path) {
+    return var::readCsv(path);
+}
+
+var readCsv(const std::string& path, const CsvOptions& options) {
+    return var::readCsv(path, options);
+}
+
+ColumnarTable readCsvColumnar(const std::string& path) {
+    return var::readCsvColumnar(path);
+}
+
+ColumnarTable readCsvColumnar(const std::string& path, const CsvOptions& options) {
+    return var::readCsvColumnar(path, options);
+}
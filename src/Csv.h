@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Columnar.h"
+
+#include <string_view>
+
+// Options for var::readCsv and var::readCsvColumnar.
+//
+// Unquoted cells are typed: empty cells become Null, then cells that start with
+// a digit, '.' or '-' are tried as Int and Double with std::from_chars, and
+// anything else (including nan and inf) stays a String. Quoted cells are
+// always Strings. In columnar output a column is Int if all its cells are Ints,
+// Double if they are all numbers, and String otherwise (keeping the raw text).
+//
+// Chunk boundaries are found with a parallel count of quote characters, so a
+// quote character may only appear in quoted cells, as RFC 4180 requires.
+struct CsvOptions {
+    char delimiter = ',';
+    char quote = '"';
+    bool header = true;                 // Otherwise columns are named column1, column2, ...
+    RowKind rowKind = RowKind::Table;   // Row container for readCsv
+    size_t threads = 0;                 // 0 uses std::thread::hardware_concurrency()
+    size_t chunkSize = 8 << 20;         // Target bytes per chunk
+};
+
+// Parse CSV text already in memory with the same parallel chunked parser
+var parseCsv(std::string_view text, const CsvOptions& options = CsvOptions());
+ColumnarTable parseCsvColumnar(std::string_view text, const CsvOptions& options = CsvOptions());
@@ -0,0 +1,667 @@
+#include "Expression.h"
+#include "Operators.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <limits>
+
+// ------------------------ Bytecode ------------------------
+
+namespace {
+    enum class OpCode : uint8_t {
+        LoadConst,   // dst = constants[extra]
+        LoadInput,   // dst = input
+        GetField,    // dst = a.fieldKeys[extra], through caches[extra]
+        GetIndex,    // dst = a[b]
+        Add,         // dst = a + b
+        Sub,         // dst = a - b
+        Mul,         // dst = a * b
+        Div,         // dst = a / b
+        Mod,         // dst = a % b
+        Neg,         // dst = -a
+        Not,         // dst = !a
+        Eq,          // dst = a == b
+        Ne,          // dst = a != b
+        Lt,          // dst = a < b
+        Le,          // dst = a <= b
+        Gt,          // dst = a > b
+        Ge,          // dst = a >= b
+        Truthy,      // dst = a ? 1 : 0
+        Jump,        // pc = extra
+        JumpIfFalse, // if !a: pc = extra
+        JumpIfTrue,  // if a: pc = extra
+        Len,         // dst = len(a)
+        Range,       // dst = range(a .. a + b)
+        Slice,       // dst = slice(a .. a + b)
+        Return       // result = a
+    };
+
+    struct Instruction {
+        OpCode op;
+        uint16_t dst = 0;
+        uint16_t a = 0;
+        uint16_t b = 0;
+        uint32_t extra = 0;
+    };
+}
+
+struct ExpressionCode {
+    std::string source;
+    std::vector<Instruction> code;
+    std::vector<var> constants;
+    std::vector<std::string> fieldKeys; // One per GetField site, each with its own inline cache
+    size_t registerCount = 1;
+};
+
+// ------------------------ Compiler ------------------------
+
+namespace {
+    enum class TokenKind {
+        End, Int, Double, String, Identifier, Dollar,
+        LParen, RParen, LBracket, RBracket, Dot, Comma,
+        Plus, Minus, Star, Slash, Percent, Bang,
+        AndAnd, OrOr, EqEq, NotEq, Less, LessEq, Greater, GreaterEq
+    };
+
+    // Largest Int literal: INT_MAX + 1, which is only an int after a unary minus
+    constexpr long long kIntLiteralMax = static_cast<long long>(std::numeric_limits<int>::max()) + 1;
+
+    struct Token {
+        TokenKind kind = TokenKind::End;
+        size_t position = 0;
+        std::string text;
+        long long intValue = 0; // At most 2^31, so a leading minus can fold it into INT_MIN
+        double doubleValue = 0.0;
+    };
+
+    // Recursive descent parser that emits bytecode directly. Registers are used
+    // as a stack: every parse function leaves its result in a fresh register on
+    // top, and binary operators write their result over their left operand.
+    class Compiler {
+    public:
+        explicit Compiler(std::string_view source) : source_(source), code_(std::make_shared<ExpressionCode>()) {
+            code_->source = std::string(source);
+            advance();
+        }
+
+        std::shared_ptr<const ExpressionCode> compile() {
+            uint16_t result = parseOr();
+            if (token_.kind != TokenKind::End) fail("unexpected '" + token_.text + "'");
+            emit(OpCode::Return, 0, result);
+            return code_;
+        }
+
+    private:
+        [[noreturn]] void fail(const std::string& message) const {
+            throw std::invalid_argument("Expression error at column " + std::to_string(token_.position + 1) + ": " + message);
+        }
+
+        void expect(TokenKind kind, const char* what) {
+            if (token_.kind != kind) fail(std::string("expected ") + what);
+            advance();
+        }
+
+        // ---- Lexer ----
+
+        void advance() {
+            while (pos_ < source_.size() && std::isspace(static_cast<unsigned char>(source_[pos_]))) ++pos_;
+            token_ = Token{};
+            token_.position = pos_;
+            if (pos_ >= source_.size()) return;
+
+            char c = source_[pos_];
+            if (std::isdigit(static_cast<unsigned char>(c)) ||
+                (c == '.' && pos_ + 1 < source_.size() && std::isdigit(static_cast<unsigned char>(source_[pos_ + 1])))) {
+                lexNumber();
+            }
+            else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                size_t start = pos_;
+                while (pos_ < source_.size() && (std::isalnum(static_cast<unsigned char>(source_[pos_])) || source_[pos_] == '_')) ++pos_;
+                token_.kind = TokenKind::Identifier;
+                token_.text = std::string(source_.substr(start, pos_ - start));
+            }
+            else if (c == '"' || c == '\'') {
+                lexString(c);
+            }
+            else {
+                lexOperator();
+            }
+        }
+
+        void lexNumber() {
+            size_t start = pos_;
+            bool isDouble = false;
+            while (pos_ < source_.size()) {
+                char c = source_[pos_];
+                if (std::isdigit(static_cast<unsigned char>(c))) ++pos_;
+                else if (c == '.' || c == 'e' || c == 'E') {
+                    isDouble = true;
+                    ++pos_;
+                    if ((c == 'e' || c == 'E') && pos_ < source_.size() && (source_[pos_] == '+' || source_[pos_] == '-')) ++pos_;
+                }
+                else break;
+            }
+            token_.text = std::string(source_.substr(start, pos_ - start));
+            const char* first = source_.data() + start;
+            const char* last = source_.data() + pos_;
+            if (!isDouble) {
+                auto [end, error] = std::from_chars(first, last, token_.intValue);
+                if (error == std::errc() && end == last && token_.intValue <= kIntLiteralMax) {
+                    token_.kind = TokenKind::Int;
+                    return;
+                }
+            }
+            // Non-integers and integers too large for int (or its negation) become doubles
+            auto [end, error] = std::from_chars(first, last, token_.doubleValue);
+            if (error != std::errc() || end != last) fail("invalid number '" + token_.text + "'");
+            token_.kind = TokenKind::Double;
+        }
+
+        void lexString(char quote) {
+            ++pos_;
+            std::string text;
+            while (pos_ < source_.size() && source_[pos_] != quote) {
+                char c = source_[pos_++];
+                if (c == '\\' && pos_ < source_.size()) {
+                    char escaped = source_[pos_++];
+                    switch (escaped) {
+                    case 'n': c = '\n'; break;
+                    case 't': c = '\t'; break;
+                    case 'r': c = '\r'; break;
+                    default: c = escaped; break;
+                    }
+                }
+                text.push_back(c);
+            }
+            if (pos_ >= source_.size()) fail("unterminated string");
+            ++pos_;
+            token_.kind = TokenKind::String;
+            token_.text = std::move(text);
+        }
+
+        void lexOperator() {
+            static const struct {
+                const char* text;
+                TokenKind kind;
+            } operators[] = {
+                { "&&", TokenKind::AndAnd }, { "||", TokenKind::OrOr }, { "==", TokenKind::EqEq },
+                { "!=", TokenKind::NotEq }, { "<=", TokenKind::LessEq }, { ">=", TokenKind::GreaterEq },
+                { "<", TokenKind::Less }, { ">", TokenKind::Greater }, { "+", TokenKind::Plus },
+                { "-", TokenKind::Minus }, { "*", TokenKind::Star }, { "/", TokenKind::Slash },
+                { "%", TokenKind::Percent }, { "!", TokenKind::Bang }, { "(", TokenKind::LParen },
+                { ")", TokenKind::RParen }, { "[", TokenKind::LBracket }, { "]", TokenKind::RBracket },
+                { ".", TokenKind::Dot }, { ",", TokenKind::Comma }, { "$", TokenKind::Dollar },
+            };
+            for (const auto& op : operators) {
+                if (source_.substr(pos_).starts_with(op.text)) {
+                    token_.kind = op.kind;
+                    token_.text = op.text;
+                    pos_ += token_.text.size();
+                    return;
+                }
+            }
+            token_.text = std::string(1, source_[pos_]);
+            fail("unexpected '" + token_.text + "'");
+        }
+
+        // ---- Code generation ----
+
+        uint16_t allocate() {
+            if (nextRegister_ >= std::numeric_limits<uint16_t>::max()) fail("expression too complex");
+            uint16_t reg = static_cast<uint16_t>(nextRegister_++);
+            code_->registerCount = std::max(code_->registerCount, nextRegister_);
+            return reg;
+        }
+
+        size_t emit(OpCode op, uint16_t dst, uint16_t a = 0, uint16_t b = 0, uint32_t extra = 0) {
+            code_->code.push_back({ op, dst, a, b, extra });
+            return code_->code.size() - 1;
+        }
+
+        void patchJump(size_t jump) {
+            code_->code[jump].extra = static_cast<uint32_t>(code_->code.size());
+        }
+
+        uint16_t loadConstant(var value) {
+            uint16_t dst = allocate();
+            code_->constants.push_back(std::move(value));
+            emit(OpCode::LoadConst, dst, 0, 0, static_cast<uint32_t>(code_->constants.size() - 1));
+            return dst;
+        }
+
+        // ---- Grammar ----
+
+        // Short-circuit operators yield 1 or 0
+        uint16_t parseOr() {
+            uint16_t lhs = parseAnd();
+            if (token_.kind != TokenKind::OrOr) return lhs;
+            emit(OpCode::Truthy, lhs, lhs);
+            std::vector<size_t> exits;
+            while (token_.kind == TokenKind::OrOr) {
+                advance();
+                exits.push_back(emit(OpCode::JumpIfTrue, 0, lhs));
+                uint16_t rhs = parseAnd();
+                emit(OpCode::Truthy, lhs, rhs);
+                nextRegister_ = lhs + 1u;
+            }
+            for (size_t jump : exits) patchJump(jump);
+            return lhs;
+        }
+
+        uint16_t parseAnd() {
+            uint16_t lhs = parseComparison();
+            if (token_.kind != TokenKind::AndAnd) return lhs;
+            emit(OpCode::Truthy, lhs, lhs);
+            std::vector<size_t> exits;
+            while (token_.kind == TokenKind::AndAnd) {
+                advance();
+                exits.push_back(emit(OpCode::JumpIfFalse, 0, lhs));
+                uint16_t rhs = parseComparison();
+                emit(OpCode::Truthy, lhs, rhs);
+                nextRegister_ = lhs + 1u;
+            }
+            for (size_t jump : exits) patchJump(jump);
+            return lhs;
+        }
+
+        uint16_t parseComparison() {
+            uint16_t lhs = parseAdditive();
+            OpCode op;
+            switch (token_.kind) {
+            case TokenKind::EqEq: op = OpCode::Eq; break;
+            case TokenKind::NotEq: op = OpCode::Ne; break;
+            case TokenKind::Less: op = OpCode::Lt; break;
+            case TokenKind::LessEq: op = OpCode::Le; break;
+            case TokenKind::Greater: op = OpCode::Gt; break;
+            case TokenKind::GreaterEq: op = OpCode::Ge; break;
+            default: return lhs;
+            }
+            advance();
+            uint16_t rhs = parseAdditive();
+            emit(op, lhs, lhs, rhs);
+            nextRegister_ = lhs + 1u;
+            return lhs;
+        }
+
+        uint16_t parseAdditive() {
+            uint16_t lhs = parseMultiplicative();
+            while (token_.kind == TokenKind::Plus || token_.kind == TokenKind::Minus) {
+                OpCode op = token_.kind == TokenKind::Plus ? OpCode::Add : OpCode::Sub;
+                advance();
+                uint16_t rhs = parseMultiplicative();
+                emit(op, lhs, lhs, rhs);
+                nextRegister_ = lhs + 1u;
+            }
+            return lhs;
+        }
+
+        uint16_t parseMultiplicative() {
+            uint16_t lhs = parseUnary();
+            while (token_.kind == TokenKind::Star || token_.kind == TokenKind::Slash || token_.kind == TokenKind::Percent) {
+                OpCode op = token_.kind == TokenKind::Star ? OpCode::Mul : token_.kind == TokenKind::Slash ? OpCode::Div : OpCode::Mod;
+                advance();
+                uint16_t rhs = parseUnary();
+                emit(op, lhs, lhs, rhs);
+                nextRegister_ = lhs + 1u;
+            }
+            return lhs;
+        }
+
+        uint16_t parseUnary() {
+            if (token_.kind == TokenKind::Minus) {
+                advance();
+                // Fold negative literals into constants; -2147483648 is an Int
+                if (token_.kind == TokenKind::Int) {
+                    int value = static_cast<int>(-token_.intValue);
+                    advance();
+                    return parsePostfix(loadConstant(var(value)));
+                }
+                if (token_.kind == TokenKind::Double) {
+                    double value = -token_.doubleValue;
+                    advance();
+                    return parsePostfix(loadConstant(var(value)));
+                }
+                uint16_t operand = parseUnary();
+                emit(OpCode::Neg, operand, operand);
+                return operand;
+            }
+            if (token_.kind == TokenKind::Bang) {
+                advance();
+                uint16_t operand = parseUnary();
+                emit(OpCode::Not, operand, operand);
+                return operand;
+            }
+            return parsePostfix(parsePrimary());
+        }
+
+        // Field and index access write over the object register, so a result
+        // that borrows from an owned object keeps that object alive
+        uint16_t parsePostfix(uint16_t object) {
+            while (true) {
+                if (token_.kind == TokenKind::Dot) {
+                    advance();
+                    if (token_.kind != TokenKind::Identifier) fail("expected field name");
+                    emitField(object, token_.text);
+                    advance();
+                }
+                else if (token_.kind == TokenKind::LBracket) {
+                    advance();
+                    uint16_t index = parseOr();
+                    expect(TokenKind::RBracket, "']'");
+                    emit(OpCode::GetIndex, object, object, index);
+                    nextRegister_ = object + 1u;
+                }
+                else {
+                    return object;
+                }
+            }
+        }
+
+        void emitField(uint16_t object, const std::string& key) {
+            code_->fieldKeys.push_back(key);
+            emit(OpCode::GetField, object, object, 0, static_cast<uint32_t>(code_->fieldKeys.size() - 1));
+        }
+
+        uint16_t parsePrimary() {
+            switch (token_.kind) {
+            case TokenKind::Int: {
+                // 2147483648 only fits once negated; on its own it is a Double
+                long long value = token_.intValue;
+                advance();
+                if (varops::fitsInt(value)) return loadConstant(var(static_cast<int>(value)));
+                return loadConstant(var(static_cast<double>(value)));
+            }
+            case TokenKind::Double: {
+                double value = token_.doubleValue;
+                advance();
+                return loadConstant(var(value));
+            }
+            case TokenKind::String: {
+                std::string value = std::move(token_.text);
+                advance();
+                return loadConstant(var(std::move(value)));
+            }
+            case TokenKind::Dollar: {
+                advance();
+                uint16_t dst = allocate();
+                emit(OpCode::LoadInput, dst);
+                return dst;
+            }
+            case TokenKind::LParen: {
+                advance();
+                uint16_t inner = parseOr();
+                expect(TokenKind::RParen, "')'");
+                return inner;
+            }
+            case TokenKind::Identifier:
+                return parseIdentifier();
+            default:
+                fail(token_.kind == TokenKind::End ? "unexpected end of expression" : "unexpected '" + token_.text + "'");
+            }
+        }
+
+        uint16_t parseIdentifier() {
+            std::string name = std::move(token_.text);
+            advance();
+            if (token_.kind == TokenKind::LParen) return parseCall(name);
+            if (name == "true") return loadConstant(var(1));
+            if (name == "false") return loadConstant(var(0));
+            if (name == "null") return loadConstant(var());
+
+            // Bare identifiers are fields of the input
+            uint16_t dst = allocate();
+            emit(OpCode::LoadInput, dst);
+            emitField(dst, name);
+            return dst;
+        }
+
+        uint16_t parseCall(const std::string& name) {
+            OpCode op;
+            size_t minArgs, maxArgs;
+            if (name == "len") { op = OpCode::Len; minArgs = 1; maxArgs = 1; }
+            else if (name == "range") { op = OpCode::Range; minArgs = 1; maxArgs = 3; }
+            else if (name == "slice") { op = OpCode::Slice; minArgs = 2; maxArgs = 4; }
+            else fail("unknown function '" + name + "'");
+
+            advance();
+            // Arguments land in consecutive registers starting at base
+            uint16_t base = static_cast<uint16_t>(nextRegister_);
+            size_t count = 0;
+            if (token_.kind != TokenKind::RParen) {
+                while (true) {
+                    parseOr();
+                    ++count;
+                    if (token_.kind != TokenKind::Comma) break;
+                    advance();
+                }
+            }
+            expect(TokenKind::RParen, "')'");
+            if (count < minArgs || count > maxArgs) fail("wrong number of arguments to " + name);
+
+            nextRegister_ = base;
+            uint16_t dst = allocate();
+            emit(op, dst, base, static_cast<uint16_t>(count));
+            return dst;
+        }
+
+        std::string_view source_;
+        size_t pos_ = 0;
+        Token token_;
+        size_t nextRegister_ = 1; // Register 0 is the input
+        std::shared_ptr<ExpressionCode> code_;
+    };
+}
+
+Expression Expression::compile(std::string_view source) {
+    return Expression(Compiler(source).compile());
+}
+
+var Expression::evaluate(const var& input) const {
+    ExpressionEvaluator evaluator(*this);
+    return evaluator.evaluate(input);
+}
+
+const std::string& Expression::source() const {
+    return code_->source;
+}
+
+size_t Expression::registerCount() const {
+    return code_->registerCount;
+}
+
+// ------------------------ Evaluator ------------------------
+
+namespace {
+    template <typename Reg>
+    void storeDouble(Reg& reg, double value) {
+        reg.ref = nullptr;
+        if (double* slot = std::get_if<double>(&reg.own.value)) *slot = value;
+        else reg.own.value = value;
+    }
+
+    // Int results that do not fit in an int are promoted to double
+    template <typename Reg>
+    void storeInt(Reg& reg, long long value) {
+        if (!varops::fitsInt(value)) {
+            storeDouble(reg, static_cast<double>(value));
+            return;
+        }
+        reg.ref = nullptr;
+        if (int* slot = std::get_if<int>(&reg.own.value)) *slot = static_cast<int>(value);
+        else reg.own.value = static_cast<int>(value);
+    }
+
+    template <typename Reg>
+    void storeVar(Reg& reg, var&& value) {
+        reg.own = std::move(value);
+        reg.ref = nullptr;
+    }
+
+    bool truthy(const var& value) {
+        switch (getVarType(value)) {
+        case varType::Null: return false;
+        case varType::Int: return std::get<int>(value.value) != 0;
+        case varType::Double: return std::get<double>(value.value) != 0.0;
+        case varType::String: return !value.getString().empty();
+        case varType::Array:
+        case varType::Table:
+        case varType::OrderedTable:
+        case varType::Record:
+            return var::len(value) != 0;
+        default: return true;
+        }
+    }
+
+    // Arithmetic and comparison follow the var operators (see Operators.h)
+    BinaryOp binaryOp(OpCode op) {
+        switch (op) {
+        case OpCode::Add: return BinaryOp::Add;
+        case OpCode::Sub: return BinaryOp::Sub;
+        case OpCode::Mul: return BinaryOp::Mul;
+        case OpCode::Div: return BinaryOp::Div;
+        case OpCode::Mod: return BinaryOp::Mod;
+        case OpCode::Eq: return BinaryOp::Eq;
+        case OpCode::Ne: return BinaryOp::Ne;
+        case OpCode::Lt: return BinaryOp::Lt;
+        case OpCode::Le: return BinaryOp::Le;
+        case OpCode::Gt: return BinaryOp::Gt;
+        default: return BinaryOp::Ge;
+        }
+    }
+
+    const var* findIndex(const var& object, const var& index) {
+        if (object.isArray()) {
+            if (!index.isInt()) throw std::runtime_error("Array index is not an Int");
+            const Array& arr = object.getArray();
+            long long i = std::get<int>(index.value);
+            if (i < 0) i += static_cast<long long>(arr.size());
+            if (i < 0 || i >= static_cast<long long>(arr.size())) throw std::out_of_range("Index out of range");
+            return &arr[static_cast<size_t>(i)];
+        }
+        if (!index.isString()) throw std::runtime_error("Table key is not a String");
+        if (!object.isKeyed()) throw std::runtime_error("var is not an Array or Table");
+        const var* found = object.find(index.getString().view());
+        if (!found) throw std::out_of_range("Key not found");
+        return found;
+    }
+
+    int intArgument(const var& value) {
+        if (!value.isInt()) throw std::runtime_error("Argument is not an Int");
+        return std::get<int>(value.value);
+    }
+}
+
+ExpressionEvaluator::ExpressionEvaluator(const Expression& expression)
+    : code_(expression.code_), registers_(code_->registerCount) {
+    caches_.reserve(code_->fieldKeys.size());
+    for (const std::string& key : code_->fieldKeys) caches_.emplace_back(key);
+}
+
+var ExpressionEvaluator::evaluate(const var& input) {
+    const std::vector<Instruction>& code = code_->code;
+    Register* regs = registers_.data();
+    regs[0].ref = &input;
+
+    size_t pc = 0;
+    while (true) {
+        const Instruction& in = code[pc++];
+        switch (in.op) {
+        case OpCode::LoadConst:
+            regs[in.dst].ref = &code_->constants[in.extra];
+            break;
+        case OpCode::LoadInput:
+            regs[in.dst].ref = &input;
+            break;
+        case OpCode::GetField: {
+            const var* found = caches_[in.extra].find(regs[in.a].get());
+            if (!found) throw std::out_of_range("Key not found");
+            regs[in.dst].ref = found;
+            break;
+        }
+        case OpCode::GetIndex:
+            regs[in.dst].ref = findIndex(regs[in.a].get(), regs[in.b].get());
+            break;
+        case OpCode::Add:
+        case OpCode::Sub:
+        case OpCode::Mul:
+        case OpCode::Div:
+        case OpCode::Mod: {
+            const var& x = regs[in.a].get();
+            const var& y = regs[in.b].get();
+            if (x.isInt() && y.isInt()) {
+                storeInt(regs[in.dst], varops::intArithmetic(binaryOp(in.op), std::get<int>(x.value), std::get<int>(y.value)));
+            }
+            else if (x.isNumber() && y.isNumber()) {
+                storeDouble(regs[in.dst], varops::doubleArithmetic(binaryOp(in.op), x.toDouble(), y.toDouble()));
+            }
+            else {
+                var result = varops::scalarArithmetic(binaryOp(in.op), x, y);
+                storeVar(regs[in.dst], std::move(result));
+            }
+            break;
+        }
+        case OpCode::Neg: {
+            const var& x = regs[in.a].get();
+            if (x.isInt()) storeInt(regs[in.dst], -static_cast<long long>(std::get<int>(x.value)));
+            else if (x.isDouble()) storeDouble(regs[in.dst], -std::get<double>(x.value));
+            else throw std::runtime_error("Unsupported operand type for -: " + x.typeOf());
+            break;
+        }
+        case OpCode::Not:
+            storeInt(regs[in.dst], truthy(regs[in.a].get()) ? 0 : 1);
+            break;
+        case OpCode::Eq:
+        case OpCode::Ne:
+        case OpCode::Lt:
+        case OpCode::Le:
+        case OpCode::Gt:
+        case OpCode::Ge: {
+            const var& x = regs[in.a].get();
+            const var& y = regs[in.b].get();
+            bool result = x.isInt() && y.isInt()
+                ? varops::compareValues(binaryOp(in.op), std::get<int>(x.value), std::get<int>(y.value))
+                : varops::compare(binaryOp(in.op), x, y);
+            storeInt(regs[in.dst], result ? 1 : 0);
+            break;
+        }
+        case OpCode::Truthy:
+            storeInt(regs[in.dst], truthy(regs[in.a].get()) ? 1 : 0);
+            break;
+        case OpCode::Jump:
+            pc = in.extra;
+            break;
+        case OpCode::JumpIfFalse:
+            if (!truthy(regs[in.a].get())) pc = in.extra;
+            break;
+        case OpCode::JumpIfTrue:
+            if (truthy(regs[in.a].get())) pc = in.extra;
+            break;
+        case OpCode::Len: {
+            const var& x = regs[in.a].get();
+            size_t length = x.isString() ? x.getString().size() : var::len(x);
+            storeInt(regs[in.dst], static_cast<long long>(length));
+            break;
+        }
+        case OpCode::Range: {
+            const Register* args = regs + in.a;
+            var result = in.b == 1 ? var::range(intArgument(args[0].get()))
+                : var::range(intArgument(args[0].get()), intArgument(args[1].get()), in.b == 3 ? intArgument(args[2].get()) : 1);
+            storeVar(regs[in.dst], std::move(result));
+            break;
+        }
+        case OpCode::Slice: {
+            const Register* args = regs + in.a;
+            const var& arr = args[0].get();
+            int start = intArgument(args[1].get());
+            int end = in.b >= 3 ? intArgument(args[2].get()) : static_cast<int>(var::len(arr));
+            int step = in.b == 4 ? intArgument(args[3].get()) : 1;
+            var result = var::slice(arr, start, end, step);
+            storeVar(regs[in.dst], std::move(result));
+            break;
+        }
+        case OpCode::Return:
+            return regs[in.a].get();
+        }
+    }
+}
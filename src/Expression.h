@@ -0,0 +1,60 @@
+#pragma once
+
+#include "HighCPP.h"
+
+struct ExpressionCode;
+
+// An expression compiled once to register-based bytecode and evaluated against
+// any number of input vars. Bare identifiers read fields of the input table and
+// $ is the input itself:
+//
+//   Expression rule = Expression::compile("price * qty > 100 && len(tags) > 0");
+//   for (const var& row : rows.getArray()) if (rule.evaluate(row).getInt()) ...
+//
+// Supported: int, double and string literals, null, true/false (1/0),
+// + - * / % with int/double promotion, comparisons (yielding 1 or 0), && || !,
+// field access (a.b), indexing (a[i], a["key"]) and the len/range/slice functions.
+// Arithmetic and comparison follow the var operators in Operators.h: int / int
+// is integer division, int results that overflow become doubles, and == compares
+// Arrays and Tables structurally.
+// Compile errors throw std::invalid_argument, evaluation errors the same
+// exceptions as the corresponding var functions.
+class Expression {
+public:
+    static Expression compile(std::string_view source);
+
+    // Convenience evaluation with fresh registers; use an ExpressionEvaluator in loops
+    var evaluate(const var& input) const;
+
+    const std::string& source() const;
+    size_t registerCount() const;
+
+private:
+    friend class ExpressionEvaluator;
+    explicit Expression(std::shared_ptr<const ExpressionCode> code) : code_(std::move(code)) {}
+
+    std::shared_ptr<const ExpressionCode> code_;
+};
+
+// Reusable execution state for one Expression: registers plus one inline cache
+// per field access. Reusing it across inputs avoids reallocating registers and
+// keeps Record lookups on their cached slots. Not thread-safe; use one per thread.
+class ExpressionEvaluator {
+public:
+    explicit ExpressionEvaluator(const Expression& expression);
+
+    var evaluate(const var& input);
+
+private:
+    // A register either borrows a value (constants, fields of the input) or owns one
+    struct Register {
+        const var* ref = nullptr;
+        var own;
+
+        const var& get() const { return ref ? *ref : own; }
+    };
+
+    std::shared_ptr<const ExpressionCode> code_;
+    std::vector<Register> registers_;
+    std::vector<PropertyCache> caches_;
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+// Minimal C++20 generator: a lazily evaluated sequence of values produced by a
+// coroutine with co_yield. Values are copied into the promise, so a yielded view
+// stays valid only until the coroutine is resumed.
+template <typename T>
+class Generator {
+public:
+    struct promise_type {
+        T current{};
+        std::exception_ptr exception;
+
+        Generator get_return_object() {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(T value) noexcept(std::is_nothrow_move_assignable_v<T>) {
+            current = std::move(value);
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+        const T& operator*() const { return handle_.promise().current; }
+        iterator& operator++() {
+            handle_.resume();
+            rethrowIfFailed(handle_);
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+        bool operator==(std::default_sentinel_t) const { return !handle_ || handle_.done(); }
+
+    private:
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    Generator() = default;
+    Generator(Generator&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Generator& operator=(Generator&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    ~Generator() {
+        if (handle_) handle_.destroy();
+    }
+
+    // Range interface; begin() runs the coroutine up to its first co_yield
+    iterator begin() {
+        if (handle_) {
+            handle_.resume();
+            rethrowIfFailed(handle_);
+        }
+        return iterator(handle_);
+    }
+    std::default_sentinel_t end() const { return {}; }
+
+    // Pull interface: advances to the next value, returns false when exhausted
+    bool next() {
+        if (!handle_ || handle_.done()) return false;
+        handle_.resume();
+        rethrowIfFailed(handle_);
+        return !handle_.done();
+    }
+    const T& value() const { return handle_.promise().current; }
+
+private:
+    explicit Generator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    static void rethrowIfFailed(std::coroutine_handle<promise_type> handle) {
+        if (handle.done() && handle.promise().exception) {
+            std::rethrow_exception(std::exchange(handle.promise().exception, nullptr));
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
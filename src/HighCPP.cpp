@@ -1,239 +1,311 @@
-#include "HighCpp.h"
+#include "HighCPP.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <utility>
 
 // Constructors
 var::var() : value(std::monostate{}) {}
 var::var(int v) : value(v) {}
 var::var(double v) : value(v) {}
-var::var(const std::string& v) : value(v) {}
-var::var(std::string&& v) : value(std::move(v)) {}
-var::var(const char* v) : value(std::string(v)) {}
+var::var(const VarString& v) : value(v) {}
+var::var(VarString&& v) : value(std::move(v)) {}
+var::var(const std::string& v) : value(VarString(v)) {}
+var::var(std::string_view v) : value(VarString(v)) {}
+var::var(const char* v) : value(VarString(v)) {}
 var::var(const Array& v) : value(v) {}
 var::var(Array&& v) : value(std::move(v)) {}
 var::var(const Table& v) : value(v) {}
 var::var(Table&& v) : value(std::move(v)) {}
+var::var(const OrderedTable& v) : value(v) {}
+var::var(OrderedTable&& v) : value(std::move(v)) {}
+var::var(const Record& v) : value(v) {}
+var::var(Record&& v) : value(std::move(v)) {}
 var::var(const Pointer& v) : value(v) {}
 var::var(Pointer&& v) : value(std::move(v)) {}
+var::var(const Shared& v) : value(v) {}
+var::var(Shared&& v) : value(std::move(v)) {}
 var::var(const std::any& v) : value(v) {}
 var::var(std::any&& v) : value(std::move(v)) {}
 var::var(void* v) : value(v) {} // Constructor for void*
+var::var(std::shared_ptr<void> v) : value(std::move(v)) {}
+var::var(UniquePointer&& v) : value(std::move(v)) {}
 
-// Template constructors
-template <typename T, typename>
-var::var(T&& v) : value(std::any(std::forward<T>(v))) {}
+// ------------------------ Iterative Traversal Helpers ------------------------
+// Copying, destroying and printing walk the tree with an explicit heap-allocated
+// work stack, so nesting depth and long Pointer chains never recurse on the call stack.
+// Printing keeps one frame per open container rather than one task per node.
 
-template <typename T, typename>
-var::var(T ptr) : value(ptr) {}
+namespace {
+    // Pending deep copy of *source into *target
+    struct CopyTask {
+        const var* source;
+        var* target;
+    };
 
-template <typename T, typename>
-var::var(const T& wp) {
-    std::weak_ptr<void> wp_void;
-    if (auto sp = wp.lock()) {
-        wp_void = std::static_pointer_cast<void>(sp);
+    // True for alternatives that can own other vars
+    bool isContainerIndex(size_t index) {
+        return index == 4 || index == 5 || index == 6 || index == 7 || index == 12 || index == 13;
     }
-    value = wp_void;
-}
 
-// Copy Constructor for Deep Copy
-var::var(const var& other) {
-    // Handle each type accordingly
-    switch (other.value.index()) {
-    case 0: // std::monostate
-        value = std::monostate{};
-        break;
-    case 1: // int
-        value = std::get<int>(other.value);
-        break;
-    case 2: // double
-        value = std::get<double>(other.value);
-        break;
-    case 3: // std::string
-        value = std::get<std::string>(other.value);
-        break;
-    case 4: // Array
-        value = std::get<Array>(other.value);
-        break;
-    case 5: // Table
-        value = std::get<Table>(other.value);
+    // Copies one node into target. Children of containers are allocated in place
+    // and queued in pending instead of being copied recursively.
+    void copyNode(const var& source, var& target, std::vector<CopyTask>& pending) {
+        auto copyChild = [&](const var& child, var& slot) {
+            if (isContainerIndex(child.value.index())) pending.push_back({ &child, &slot });
+            else copyNode(child, slot, pending);
+        };
+
+        switch (source.value.index()) {
+        case 0: // std::monostate
+            target.value = std::monostate{};
+            break;
+        case 1: // int
+            target.value = std::get<int>(source.value);
+            break;
+        case 2: // double
+            target.value = std::get<double>(source.value);
+            break;
+        case 3: // VarString; long strings share their buffer
+            target.value = std::get<VarString>(source.value);
+            break;
+        case 4: // Array
+        {
+            const Array& original = std::get<Array>(source.value);
+            Array& copy = target.value.emplace<Array>(original.size());
+            for (size_t i = 0; i < original.size(); ++i) {
+                copyChild(original[i], copy[i]);
+            }
+        }
         break;
-    case 6: // Pointer (shared_ptr<var>)
-    {
-        auto originalPtr = std::get<Pointer>(other.value);
-        if (originalPtr) {
-            // Perform a deep copy
-            value = std::make_shared<var>(*originalPtr);
+        case 5: // Table
+        {
+            const Table& original = std::get<Table>(source.value);
+            Table& copy = target.value.emplace<Table>();
+            copy.reserve(original.size());
+            for (const auto& [key, child] : original) {
+                copyChild(child, copy.try_emplace(key).first->second);
+            }
         }
-        else {
-            value = Pointer(nullptr);
+        break;
+        case 6: // Pointer (shared_ptr<var>)
+        {
+            const var::Pointer& originalPtr = std::get<var::Pointer>(source.value);
+            if (originalPtr) {
+                // Perform a deep copy
+                auto copyPtr = std::make_shared<var>();
+                target.value = copyPtr;
+                pending.push_back({ originalPtr.get(), copyPtr.get() });
+            }
+            else {
+                target.value = var::Pointer(nullptr);
+            }
         }
-    }
-    break;
-    case 7: // std::any
-    {
-        const std::any& originalAny = std::get<std::any>(other.value);
-        if (originalAny.has_value()) {
-            // Attempt to copy based on the stored type
-            if (originalAny.type() == typeid(std::shared_ptr<var>)) {
-                auto originalSharedPtr = std::any_cast<std::shared_ptr<var>>(originalAny);
-                if (originalSharedPtr) {
-                    value = std::make_shared<var>(*originalSharedPtr);
+        break;
+        case 7: // std::any
+        {
+            const std::any& originalAny = std::get<std::any>(source.value);
+            if (originalAny.has_value()) {
+                // Attempt to copy based on the stored type
+                if (originalAny.type() == typeid(std::shared_ptr<var>)) {
+                    auto originalSharedPtr = std::any_cast<std::shared_ptr<var>>(originalAny);
+                    if (originalSharedPtr) {
+                        auto copyPtr = std::make_shared<var>();
+                        target.value = copyPtr;
+                        pending.push_back({ originalSharedPtr.get(), copyPtr.get() });
+                    }
+                    else {
+                        target.value = std::shared_ptr<void>(nullptr);
+                    }
                 }
                 else {
-                    value = std::shared_ptr<void>(nullptr);
+                    // For other types, perform a copy
+                    target.value = originalAny;
                 }
             }
             else {
-                // For other types, perform a copy
-                value = originalAny;
+                target.value = std::any{};
             }
         }
-        else {
-            value = std::any{};
+        break;
+        case 8: // void* (Raw Pointer)
+            target.value = std::get<void*>(source.value);
+            break;
+        case 9: // std::shared_ptr<void>
+            target.value = std::get<std::shared_ptr<void>>(source.value);
+            break;
+        case 10: // var::UniquePointer
+        {
+            // Cannot copy unique_ptr; set to nullptr or handle appropriately
+            // Here, we'll set it to nullptr
+            target.value = var::UniquePointer(nullptr, nullptr);
         }
-    }
-    break;
-    case 8: // void* (Raw Pointer)
-        value = std::get<void*>(other.value);
         break;
-    case 9: // std::shared_ptr<void>
-        value = std::get<std::shared_ptr<void>>(other.value);
+        case 11: // std::weak_ptr<void>
+            target.value = std::get<std::weak_ptr<void>>(source.value);
+            break;
+        case 12: // OrderedTable
+        {
+            const OrderedTable& original = std::get<OrderedTable>(source.value);
+            OrderedTable& copy = target.value.emplace<OrderedTable>();
+            copy.reserve(original.size());
+            for (size_t i = 0; i < original.size(); ++i) {
+                copy[original.keyAt(i)];
+            }
+            // Values are stable now that every key has been inserted
+            for (size_t i = 0; i < original.size(); ++i) {
+                copyChild(original.valueAt(i), copy.valueAt(i));
+            }
+        }
         break;
-    case 10: // std::unique_ptr<void, std::default_delete<void>>
-    {
-        // Cannot copy unique_ptr; set to nullptr or handle appropriately
-        // Here, we'll set it to nullptr
-        value = std::unique_ptr<void, std::default_delete<void>>(nullptr);
-    }
-    break;
-    case 11: // std::weak_ptr<void>
-        value = std::get<std::weak_ptr<void>>(other.value);
+        case 13: // Record; the shape is shared, only the slots are copied
+        {
+            const Record& original = std::get<Record>(source.value);
+            Record& copy = target.value.emplace<Record>(original.shape());
+            for (size_t i = 0; i < original.size(); ++i) {
+                copyChild(original.valueAt(i), copy.valueAt(i));
+            }
+        }
         break;
-    default:
-        throw std::runtime_error("Unknown var type during copy construction.");
+        case 14: // Shared; immutable, so copies share it
+            target.value = std::get<var::Shared>(source.value);
+            break;
+        default:
+            throw std::runtime_error("Unknown var type during copy.");
+        }
     }
-}
-
-// Copy Assignment Operator for Deep Copy
-var& var::operator=(const var& other) {
-    if (this == &other) return *this; // Self-assignment check
 
-    // Clear current value
-    value = std::monostate{};
-
-    // Handle each type accordingly
-    switch (other.value.index()) {
-    case 0: // std::monostate
-        value = std::monostate{};
-        break;
-    case 1: // int
-        value = std::get<int>(other.value);
-        break;
-    case 2: // double
-        value = std::get<double>(other.value);
-        break;
-    case 3: // std::string
-        value = std::get<std::string>(other.value);
-        break;
-    case 4: // Array
-        value = std::get<Array>(other.value);
-        break;
-    case 5: // Table
-        value = std::get<Table>(other.value);
-        break;
-    case 6: // Pointer (shared_ptr<var>)
-    {
-        auto originalPtr = std::get<Pointer>(other.value);
-        if (originalPtr) {
-            // Perform a deep copy
-            value = std::make_shared<var>(*originalPtr);
+    // True if node may own nested containers that need iterative teardown
+    bool ownsNestedVars(const var& node) {
+        switch (node.value.index()) {
+        case 4: return !std::get<Array>(node.value).empty();
+        case 5: return !std::get<Table>(node.value).empty();
+        case 6: return static_cast<bool>(std::get<var::Pointer>(node.value));
+        case 12: return !std::get<OrderedTable>(node.value).empty();
+        case 13: return !std::get<Record>(node.value).empty();
+        case 14: // Shared; only dismantled by its last owner
+        {
+            const var::Shared& ptr = std::get<var::Shared>(node.value);
+            return ptr.use_count() == 1 && ownsNestedVars(*ptr);
         }
-        else {
-            value = Pointer(nullptr);
+        default: return false;
         }
     }
-    break;
-    case 7: // std::any
-    {
-        const std::any& originalAny = std::get<std::any>(other.value);
-        if (originalAny.has_value()) {
-            // Attempt to copy based on the stored type
-            if (originalAny.type() == typeid(std::shared_ptr<var>)) {
-                auto originalSharedPtr = std::any_cast<std::shared_ptr<var>>(originalAny);
-                if (originalSharedPtr) {
-                    value = std::make_shared<var>(*originalSharedPtr);
-                }
-                else {
-                    value = std::shared_ptr<void>(nullptr);
-                }
+
+    // Moves the nested containers of node into pending, leaving node shallow
+    void detachNested(var& node, std::vector<var>& pending) {
+        switch (node.value.index()) {
+        case 4: // Array
+            for (var& child : std::get<Array>(node.value)) {
+                if (ownsNestedVars(child)) pending.push_back(std::move(child));
             }
-            else {
-                // For other types, perform a copy
-                value = originalAny;
+            break;
+        case 5: // Table
+            for (auto& [key, child] : std::get<Table>(node.value)) {
+                if (ownsNestedVars(child)) pending.push_back(std::move(child));
             }
+            break;
+        case 6: // Pointer; only dismantled when this is the last owner
+        {
+            var::Pointer& ptr = std::get<var::Pointer>(node.value);
+            if (ptr && ptr.use_count() == 1 && ownsNestedVars(*ptr)) pending.push_back(std::move(*ptr));
         }
-        else {
-            value = std::any{};
+        break;
+        case 12: // OrderedTable
+        {
+            OrderedTable& tbl = std::get<OrderedTable>(node.value);
+            for (size_t i = 0; i < tbl.size(); ++i) {
+                if (ownsNestedVars(tbl.valueAt(i))) pending.push_back(std::move(tbl.valueAt(i)));
+            }
         }
-    }
-    break;
-    case 8: // void* (Raw Pointer)
-        value = std::get<void*>(other.value);
         break;
-    case 9: // std::shared_ptr<void>
-        value = std::get<std::shared_ptr<void>>(other.value);
+        case 13: // Record
+        {
+            Record& rec = std::get<Record>(node.value);
+            for (size_t i = 0; i < rec.size(); ++i) {
+                if (ownsNestedVars(rec.valueAt(i))) pending.push_back(std::move(rec.valueAt(i)));
+            }
+        }
         break;
-    case 10: // std::unique_ptr<void, std::default_delete<void>>
-    {
-        // Cannot copy unique_ptr; set to nullptr or handle appropriately
-        // Here, we'll set it to nullptr
-        value = std::unique_ptr<void, std::default_delete<void>>(nullptr);
-    }
-    break;
-    case 11: // std::weak_ptr<void>
-        value = std::get<std::weak_ptr<void>>(other.value);
+        case 14: // Shared; only dismantled when this is the last owner
+        {
+            const var::Shared& ptr = std::get<var::Shared>(node.value);
+            // Shared nodes are always created non-const, so the last owner may move out of it
+            if (ptr.use_count() == 1 && ownsNestedVars(*ptr)) pending.push_back(std::move(const_cast<var&>(*ptr)));
+        }
         break;
-    default:
-        throw std::runtime_error("Unknown var type during copy assignment.");
+        default:
+            break;
+        }
     }
+}
 
-    return *this;
+// Copy Constructor for Deep Copy
+var::var(const var& other) {
+    std::vector<CopyTask> pending;
+    copyNode(other, *this, pending);
+    while (!pending.empty()) {
+        CopyTask task = pending.back();
+        pending.pop_back();
+        copyNode(*task.source, *task.target, pending);
+    }
 }
 
-// Template assignment operators
-template <typename T, typename>
-var& var::operator=(T&& v) {
-    value = std::any(std::forward<T>(v));
+// Copy Assignment Operator for Deep Copy
+var& var::operator=(const var& other) {
+    if (this == &other) return *this; // Self-assignment check
+
+    // Copy first so that assigning a var's own descendant to it is safe
+    var copy(other);
+    value = std::move(copy.value);
     return *this;
 }
 
-template <typename T, typename>
-var& var::operator=(T ptr) {
-    value = ptr;
-    return *this;
+// Destructor
+var::~var() {
+    if (!ownsNestedVars(*this)) return;
+    std::vector<var> pending;
+    detachNested(*this, pending);
+    while (!pending.empty()) {
+        var node = std::move(pending.back());
+        pending.pop_back();
+        detachNested(node, pending);
+    }
 }
 
-template <typename T, typename>
-var& var::operator=(const T& wp) {
-    std::weak_ptr<void> wp_void;
-    if (auto sp = wp.lock()) {
-        wp_void = std::static_pointer_cast<void>(sp);
+var& var::operator=(const VarString& v) { value = v; return *this; }
+var& var::operator=(VarString&& v) { value = std::move(v); return *this; }
+var& var::operator=(const OrderedTable& v) { value = v; return *this; }
+var& var::operator=(OrderedTable&& v) { value = std::move(v); return *this; }
+var& var::operator=(const Record& v) { value = v; return *this; }
+var& var::operator=(Record&& v) { value = std::move(v); return *this; }
+
+namespace {
+    // The value a Shared node stands for; any other var stands for itself
+    const var& resolve(const var& varObj) {
+        if (const var::Shared* shared = std::get_if<var::Shared>(&varObj.value)) return **shared;
+        return varObj;
     }
-    value = wp_void;
-    return *this;
 }
 
 // Type checking
 bool var::isInt() const { return std::holds_alternative<int>(value); }
 bool var::isDouble() const { return std::holds_alternative<double>(value); }
-bool var::isString() const { return std::holds_alternative<std::string>(value); }
-bool var::isArray() const { return std::holds_alternative<Array>(value); }
-bool var::isTable() const { return std::holds_alternative<Table>(value); }
+bool var::isString() const { return std::holds_alternative<VarString>(resolve(*this).value); }
+bool var::isArray() const { return std::holds_alternative<Array>(resolve(*this).value); }
+bool var::isTable() const { return std::holds_alternative<Table>(resolve(*this).value); }
+bool var::isOrderedTable() const { return std::holds_alternative<OrderedTable>(resolve(*this).value); }
+bool var::isRecord() const { return std::holds_alternative<Record>(resolve(*this).value); }
 bool var::isPointer() const { return std::holds_alternative<Pointer>(value); }
 bool var::isRawPointer() const { return std::holds_alternative<void*>(value); }
 bool var::isSharedPointer() const { return std::holds_alternative<std::shared_ptr<void>>(value); }
-bool var::isUniquePointer() const { return std::holds_alternative<std::unique_ptr<void, std::default_delete<void>>>(value); }
+bool var::isUniquePointer() const { return std::holds_alternative<UniquePointer>(value); }
 bool var::isWeakPointer() const { return std::holds_alternative<std::weak_ptr<void>>(value); }
 bool var::IsObject() const { return std::holds_alternative<std::any>(value); } // Renamed from isCustom()
 bool var::isNull() const { return std::holds_alternative<std::monostate>(value); }
+bool var::isShared() const { return std::holds_alternative<Shared>(value); }
+bool var::isKeyed() const { return isTable() || isOrderedTable() || isRecord(); }
 
 // Getters with type safety
 int var::getInt() const {
@@ -246,36 +318,55 @@ double var::getDouble() const {
     return std::get<double>(value);
 }
 
-const std::string& var::getString() const {
+const VarString& var::getString() const {
     if (!isString()) throw std::bad_variant_access();
-    return std::get<std::string>(value);
-}
-
-std::string& var::getString() {
-    if (!isString()) throw std::bad_variant_access();
-    return std::get<std::string>(value);
+    return std::get<VarString>(resolve(*this).value);
 }
 
 const Array& var::getArray() const {
     if (!isArray()) throw std::bad_variant_access();
-    return std::get<Array>(value);
+    return std::get<Array>(resolve(*this).value);
 }
 
 Array& var::getArray() {
     if (!isArray()) throw std::bad_variant_access();
+    unshare();
     return std::get<Array>(value);
 }
 
 const Table& var::getTable() const {
     if (!isTable()) throw std::bad_variant_access();
-    return std::get<Table>(value);
+    return std::get<Table>(resolve(*this).value);
 }
 
 Table& var::getTable() {
     if (!isTable()) throw std::bad_variant_access();
+    unshare();
     return std::get<Table>(value);
 }
 
+const OrderedTable& var::getOrderedTable() const {
+    if (!isOrderedTable()) throw std::bad_variant_access();
+    return std::get<OrderedTable>(resolve(*this).value);
+}
+
+OrderedTable& var::getOrderedTable() {
+    if (!isOrderedTable()) throw std::bad_variant_access();
+    unshare();
+    return std::get<OrderedTable>(value);
+}
+
+const Record& var::getRecord() const {
+    if (!isRecord()) throw std::bad_variant_access();
+    return std::get<Record>(resolve(*this).value);
+}
+
+Record& var::getRecord() {
+    if (!isRecord()) throw std::bad_variant_access();
+    unshare();
+    return std::get<Record>(value);
+}
+
 const var::Pointer& var::getPointer() const {
     if (!isPointer()) throw std::bad_variant_access();
     return std::get<Pointer>(value);
@@ -306,14 +397,14 @@ std::shared_ptr<void> var::getSharedPointer() const {
     return std::get<std::shared_ptr<void>>(value);
 }
 
-std::unique_ptr<void, std::default_delete<void>>& var::getUniquePointer() {
+var::UniquePointer& var::getUniquePointer() {
     if (!isUniquePointer()) throw std::bad_variant_access();
-    return std::get<std::unique_ptr<void, std::default_delete<void>>>(value);
+    return std::get<UniquePointer>(value);
 }
 
-const std::unique_ptr<void, std::default_delete<void>>& var::getUniquePointer() const {
+const var::UniquePointer& var::getUniquePointer() const {
     if (!isUniquePointer()) throw std::bad_variant_access();
-    return std::get<std::unique_ptr<void, std::default_delete<void>>>(value);
+    return std::get<UniquePointer>(value);
 }
 
 std::weak_ptr<void> var::getWeakPointer() const {
@@ -321,6 +412,24 @@ std::weak_ptr<void> var::getWeakPointer() const {
     return std::get<std::weak_ptr<void>>(value);
 }
 
+const var::Shared& var::getShared() const {
+    if (!isShared()) throw std::bad_variant_access();
+    return std::get<Shared>(value);
+}
+
+void var::unshare() {
+    if (!isShared()) return;
+    Shared shared = std::move(std::get<Shared>(value));
+    if (shared.use_count() == 1) {
+        // Last owner; Shared nodes are always created non-const
+        value = std::move(const_cast<var&>(*shared).value);
+        return;
+    }
+    // Copies one level only: the children of a Shared node are themselves Shared or scalars
+    var copy(*shared);
+    value = std::move(copy.value);
+}
+
 // Helper to get type as string
 std::string var::typeOf() const {
     if (isInt()) return "Int";
@@ -328,6 +437,8 @@ std::string var::typeOf() const {
     if (isString()) return "String";
     if (isArray()) return "Array";
     if (isTable()) return "Table";
+    if (isOrderedTable()) return "OrderedTable";
+    if (isRecord()) return "Record";
     if (isPointer()) return "Pointer";
     if (isRawPointer()) return "RawPointer";
     if (isSharedPointer()) return "SharedPointer";
@@ -337,107 +448,202 @@ std::string var::typeOf() const {
     return "Null";
 }
 
-// Overload the output operator for var
-std::ostream& operator<<(std::ostream& os, const var& varObj) {
-    if (varObj.isInt()) {
-        os << varObj.getInt();
-    }
-    else if (varObj.isDouble()) {
-        os << varObj.getDouble();
-    }
-    else if (varObj.isString()) {
-        os << '"' << varObj.getString() << '"';
+namespace {
+    // An open container or pointer whose children are still being written. The walk
+    // keeps one frame per open level, so its memory follows depth, not size
+    struct PrintFrame {
+        const var* node = nullptr;
+        size_t next = 0; // Children written so far
+        Table::const_iterator entry; // Next entry when node is a Table
+        std::shared_ptr<void> keepAlive; // Locked WeakPointer target, released when the frame is popped
+    };
+
+    bool isPointerNode(const var& varObj) {
+        return varObj.isPointer() || varObj.isSharedPointer() || varObj.isWeakPointer();
     }
-    else if (varObj.isArray()) {
-        os << "[ ";
-        const Array& arr = varObj.getArray();
-        for (const auto& item : arr) {
-            os << item << " ";
+
+    // Writes a value whole, or the opening text of a container or pointer and a frame for its children
+    void openNode(std::ostream& os, const var& varObj, std::vector<PrintFrame>& frames) {
+        if (varObj.isInt()) {
+            os << varObj.getInt();
         }
-        os << "]";
-    }
-    else if (varObj.isTable()) {
-        os << "{ ";
-        const Table& tbl = varObj.getTable();
-        for (const auto& [key, value] : tbl) {
-            os << '"' << key << "\": " << value << " ";
+        else if (varObj.isDouble()) {
+            os << varObj.getDouble();
         }
-        os << "}";
-    }
-    else if (varObj.isPointer()) {
-        os << "Pointer(";
-        if (varObj.getPointer()) {
-            os << *(varObj.getPointer());
+        else if (varObj.isString()) {
+            os << '"' << varObj.getString() << '"';
         }
-        else {
-            os << "nullptr";
+        else if (varObj.isArray()) {
+            os << "[ ";
+            frames.push_back({ &varObj });
         }
-        os << ")";
-    }
-    else if (varObj.isRawPointer()) {
-        os << "RawPointer(" << varObj.getRawPointer() << ")";
-    }
-    else if (varObj.isSharedPointer()) {
-        os << "SharedPointer(";
-        auto ptr = varObj.getSharedPointer();
-        if (ptr) {
-            // Attempt to print the pointed-to var
-            // Since stored as shared_ptr<void>, we need to cast
-            // Here, we'll assume it's pointing to var
-            auto pointedVar = std::static_pointer_cast<var>(ptr);
-            os << *pointedVar;
+        else if (varObj.isTable()) {
+            os << "{ ";
+            frames.push_back({ &varObj, 0, varObj.getTable().begin() });
         }
-        else {
-            os << "nullptr";
+        else if (varObj.isOrderedTable() || varObj.isRecord()) {
+            os << "{ ";
+            frames.push_back({ &varObj });
         }
-        os << ")";
-    }
-    else if (varObj.isUniquePointer()) {
-        os << "UniquePointer(";
-        const auto& ptr = varObj.getUniquePointer(); // Corrected line
+        else if (varObj.isPointer()) {
+            os << "Pointer(";
+            if (varObj.getPointer()) frames.push_back({ &varObj });
+            else os << "nullptr)";
+        }
+        else if (varObj.isRawPointer()) {
+            os << "RawPointer(" << varObj.getRawPointer() << ")";
+        }
+        else if (varObj.isSharedPointer()) {
+            os << "SharedPointer(";
+            // Attempt to print the pointed-to var
+            // Since stored as shared_ptr<void>, we assume it's pointing to var
+            if (varObj.getSharedPointer()) frames.push_back({ &varObj });
+            else os << "nullptr)";
+        }
+        else if (varObj.isUniquePointer()) {
+            os << "UniquePointer(";
+            const auto& ptr = varObj.getUniquePointer(); // Corrected line
 
-        if (ptr) {
-            // Print the raw address without dereferencing
-            os << ptr.get();
+            if (ptr) {
+                // Print the raw address without dereferencing
+                os << ptr.get();
+            }
+            else {
+                os << "nullptr";
+            }
+            os << ")";
+        }
+        else if (varObj.isWeakPointer()) {
+            os << "WeakPointer(";
+            auto ptr = varObj.getWeakPointer().lock();
+            // Attempt to print the pointed-to var; the frame keeps it alive until printed
+            if (ptr) frames.push_back({ &varObj, 0, {}, std::move(ptr) });
+            else os << "expired)";
+        }
+        else if (varObj.IsObject()) {
+            os << "Object(";
+            try {
+                const std::any& customObj = varObj.getObject();
+                if (customObj.has_value()) {
+                    // Generic handling for std::any
+                    os << "/* Custom Type: " << customObj.type().name() << " */";
+                }
+                else {
+                    os << "/* Empty std::any */";
+                }
+            }
+            catch (...) {
+                os << "/* Unprintable Custom Type */";
+            }
+            os << ")";
         }
         else {
-            os << "nullptr";
+            os << "Null";
         }
-        os << ")";
     }
-    else if (varObj.isWeakPointer()) {
-        os << "WeakPointer(";
-        auto ptr = varObj.getWeakPointer().lock();
-        if (ptr) {
-            // Attempt to print the pointed-to var
-            auto pointedVar = std::static_pointer_cast<var>(ptr);
-            os << *pointedVar;
+
+    // Writes the key of the next child of frame and returns the child, or nullptr once all are written
+    const var* nextChild(std::ostream& os, PrintFrame& frame) {
+        const var& node = *frame.node;
+        if (node.isArray()) {
+            const Array& arr = node.getArray();
+            return frame.next < arr.size() ? &arr[frame.next] : nullptr;
         }
-        else {
-            os << "expired";
+        if (node.isTable()) {
+            if (frame.entry == node.getTable().end()) return nullptr;
+            const auto& [key, value] = *frame.entry++;
+            os << '"' << key << "\": ";
+            return &value;
         }
-        os << ")";
+        if (node.isOrderedTable() || node.isRecord()) {
+            auto entryAt = [&](const auto& tbl) -> const var* {
+                if (frame.next >= tbl.size()) return nullptr;
+                os << '"' << tbl.keyAt(frame.next) << "\": ";
+                return &tbl.valueAt(frame.next);
+            };
+            return node.isRecord() ? entryAt(node.getRecord()) : entryAt(node.getOrderedTable());
+        }
+        // Pointers have their target as the only child
+        if (frame.next > 0) return nullptr;
+        if (node.isPointer()) return node.getPointer().get();
+        if (node.isSharedPointer()) return static_cast<const var*>(node.getSharedPointer().get());
+        return static_cast<const var*>(frame.keepAlive.get());
     }
-    else if (varObj.IsObject()) {
-        os << "Object(";
-        try {
-            const std::any& customObj = varObj.getObject();
-            if (customObj.has_value()) {
-                // Generic handling for std::any
-                os << "/* Custom Type: " << customObj.type().name() << " */";
+
+    // Resumable printing walk shared by operator<< and var::serialize
+    class PrintWalk {
+    public:
+        explicit PrintWalk(const var& root) : root_(&root) {}
+
+        bool done() const { return !root_ && frames_.empty(); }
+
+        // Writes the next piece of output: one child of the innermost open container, or its close
+        void step(std::ostream& os) {
+            if (root_) {
+                openNode(os, *std::exchange(root_, nullptr), frames_);
+                return;
             }
-            else {
-                os << "/* Empty std::any */";
+            PrintFrame& frame = frames_.back();
+            const bool pointer = isPointerNode(*frame.node);
+            // Children of containers are each followed by a space
+            if (!pointer && frame.next > 0) os << ' ';
+            const var* child = nextChild(os, frame);
+            if (!child) {
+                os << (pointer ? ")" : frame.node->isArray() ? "]" : "}");
+                frames_.pop_back();
+                return;
             }
+            ++frame.next;
+            openNode(os, *child, frames_);
         }
-        catch (...) {
-            os << "/* Unprintable Custom Type */";
+
+    private:
+        const var* root_;
+        std::vector<PrintFrame> frames_;
+    };
+
+    // Stream buffer that appends everything written through it to a std::string
+    class StringSink : public std::streambuf {
+    public:
+        explicit StringSink(std::string& out) : out_(out) {}
+
+    protected:
+        int_type overflow(int_type ch) override {
+            if (!traits_type::eq_int_type(ch, traits_type::eof())) out_.push_back(traits_type::to_char_type(ch));
+            return ch;
         }
-        os << ")";
-    }
-    else {
-        os << "Null";
+
+        std::streamsize xsputn(const char* s, std::streamsize count) override {
+            out_.append(s, static_cast<size_t>(count));
+            return count;
+        }
+
+    private:
+        std::string& out_;
+    };
+
+    Generator<std::string_view> serializeChunks(const var& root, size_t chunkSize) {
+        std::string buffer;
+        StringSink sink(buffer);
+        std::ostream os(&sink);
+        PrintWalk walk(root);
+        while (!walk.done()) {
+            walk.step(os);
+            size_t offset = 0;
+            while (buffer.size() - offset >= chunkSize) {
+                co_yield std::string_view(buffer.data() + offset, chunkSize);
+                offset += chunkSize;
+            }
+            buffer.erase(0, offset);
+        }
+        if (!buffer.empty()) co_yield std::string_view(buffer);
     }
+}
+
+// Overload the output operator for var
+std::ostream& operator<<(std::ostream& os, const var& varObj) {
+    PrintWalk walk(varObj);
+    while (!walk.done()) walk.step(os);
     return os;
 }
 
@@ -448,6 +654,8 @@ varType getVarType(const var& varObj) {
     if (varObj.isString()) return varType::String;
     if (varObj.isArray()) return varType::Array;
     if (varObj.isTable()) return varType::Table;
+    if (varObj.isOrderedTable()) return varType::OrderedTable;
+    if (varObj.isRecord()) return varType::Record;
     if (varObj.isPointer()) return varType::Pointer;
     if (varObj.isRawPointer()) return varType::RawPointer;
     if (varObj.isSharedPointer()) return varType::SharedPointer;
@@ -468,6 +676,10 @@ var var::makeArray(const Array& arr) { return var(arr); }
 var var::makeArray(Array&& arr) { return var(std::move(arr)); }
 var var::makeTable(const Table& tbl) { return var(tbl); }
 var var::makeTable(Table&& tbl) { return var(std::move(tbl)); }
+var var::makeOrderedTable(const OrderedTable& tbl) { return var(tbl); }
+var var::makeOrderedTable(OrderedTable&& tbl) { return var(std::move(tbl)); }
+var var::makeRecord(const Record& rec) { return var(rec); }
+var var::makeRecord(Record&& rec) { return var(std::move(rec)); }
 var var::makePointer(const var& varObj) { return var(std::make_shared<var>(varObj)); }
 var var::makePointer(var&& varObj) { return var(std::make_shared<var>(std::move(varObj))); }
 var var::makeCustom(const std::any& customObj) { return var(customObj); }
@@ -492,32 +704,167 @@ void var::appendElement(var& arrayVar, const var& value) {
     if (!arrayVar.isArray()) throw std::runtime_error("var is not an Array");
     arrayVar.getArray().emplace_back(value);
 }
+void var::setElement(var& arrayVar, size_t index, var&& value) {
+    if (!arrayVar.isArray()) throw std::runtime_error("var is not an Array");
+    Array& arr = arrayVar.getArray();
+    if (index >= arr.size()) arr.resize(index + 1);
+    arr[index] = std::move(value);
+}
+void var::appendElement(var& arrayVar, var&& value) {
+    if (!arrayVar.isArray()) throw std::runtime_error("var is not an Array");
+    arrayVar.getArray().emplace_back(std::move(value));
+}
 
 // Table functions
 var var::newTable(const Table& tbl) { return var(tbl); }
 var var::newTable(Table&& tbl) { return var(std::move(tbl)); }
+var var::newOrderedTable(const OrderedTable& tbl) { return var(tbl); }
+var var::newOrderedTable(OrderedTable&& tbl) { return var(std::move(tbl)); }
+var var::newRecord(const Record& rec) { return var(rec); }
+var var::newRecord(Record&& rec) { return var(std::move(rec)); }
+
+const var* var::find(std::string_view key) const {
+    if (isTable()) {
+        const Table& tbl = getTable();
+        auto it = tbl.find(key);
+        return it == tbl.end() ? nullptr : &it->second;
+    }
+    if (isRecord()) return getRecord().find(key);
+    if (isOrderedTable()) return getOrderedTable().find(key);
+    throw std::runtime_error("var is not a Table");
+}
+
+var* var::find(std::string_view key) {
+    if (isTable()) {
+        Table& tbl = getTable();
+        auto it = tbl.find(key);
+        return it == tbl.end() ? nullptr : &it->second;
+    }
+    if (isRecord()) return getRecord().find(key);
+    if (isOrderedTable()) return getOrderedTable().find(key);
+    throw std::runtime_error("var is not a Table");
+}
+
+namespace {
+    template <typename Key, typename Value>
+    void assignEntry(var& tableVar, Key&& key, Value&& value) {
+        if (tableVar.isTable()) {
+            tableVar.getTable().insert_or_assign(std::forward<Key>(key), std::forward<Value>(value));
+        }
+        else if (tableVar.isRecord()) {
+            tableVar.getRecord().insert_or_assign(key, std::forward<Value>(value));
+        }
+        else if (tableVar.isOrderedTable()) {
+            tableVar.getOrderedTable().insert_or_assign(std::forward<Key>(key), std::forward<Value>(value));
+        }
+        else {
+            throw std::runtime_error("var is not a Table");
+        }
+    }
+}
+
 var var::getElement(const var& tableVar, const std::string& key) {
-    if (!tableVar.isTable()) throw std::runtime_error("var is not a Table");
-    const Table& tbl = tableVar.getTable();
-    auto it = tbl.find(key);
-    if (it == tbl.end()) throw std::out_of_range("Key not found");
-    return it->second;
+    const var* found = tableVar.find(key);
+    if (!found) throw std::out_of_range("Key not found");
+    return *found;
+}
+var var::getElement(const var& tableVar, PropertyCache& cache) {
+    const var* found = cache.find(tableVar);
+    if (!found) throw std::out_of_range("Key not found");
+    return *found;
 }
 void var::setElement(var& tableVar, const std::string& key, const var& value) {
-    if (!tableVar.isTable()) throw std::runtime_error("var is not a Table");
-    tableVar.getTable()[key] = value;
+    assignEntry(tableVar, key, value);
 }
+void var::setElement(var& tableVar, const std::string& key, var&& value) {
+    assignEntry(tableVar, key, std::move(value));
+}
+
+// Free function forms
+var makeInt(int x) { return var::makeInt(x); }
+var makeDouble(double x) { return var::makeDouble(x); }
+var makeString(const std::string& x) { return var::makeString(x); }
+var makeString(std::string&& x) { return var::makeString(std::move(x)); }
+var makeArray(const Array& arr) { return var::makeArray(arr); }
+var makeArray(Array&& arr) { return var::makeArray(std::move(arr)); }
+var makeTable(const Table& tbl) { return var::makeTable(tbl); }
+var makeTable(Table&& tbl) { return var::makeTable(std::move(tbl)); }
+var makeOrderedTable(const OrderedTable& tbl) { return var::makeOrderedTable(tbl); }
+var makeOrderedTable(OrderedTable&& tbl) { return var::makeOrderedTable(std::move(tbl)); }
+var makeRecord(const Record& rec) { return var::makeRecord(rec); }
+var makeRecord(Record&& rec) { return var::makeRecord(std::move(rec)); }
+var makePointer(const var& varObj) { return var::makePointer(varObj); }
+var makePointer(var&& varObj) { return var::makePointer(std::move(varObj)); }
+var makeCustom(const std::any& customObj) { return var::makeCustom(customObj); }
+var makeCustom(std::any&& customObj) { return var::makeCustom(std::move(customObj)); }
+var newArray(const Array& arr) { return var::newArray(arr); }
+var newArray(Array&& arr) { return var::newArray(std::move(arr)); }
+var newTable(const Table& tbl) { return var::newTable(tbl); }
+var newTable(Table&& tbl) { return var::newTable(std::move(tbl)); }
+var newOrderedTable(const OrderedTable& tbl) { return var::newOrderedTable(tbl); }
+var newOrderedTable(OrderedTable&& tbl) { return var::newOrderedTable(std::move(tbl)); }
+var newRecord(const Record& rec) { return var::newRecord(rec); }
+var newRecord(Record&& rec) { return var::newRecord(std::move(rec)); }
+var getElement(const var& arrayVar, size_t index) { return var::getElement(arrayVar, index); }
+void setElement(var& arrayVar, size_t index, const var& value) { var::setElement(arrayVar, index, value); }
+void appendElement(var& arrayVar, const var& value) { var::appendElement(arrayVar, value); }
+var getElement(const var& tableVar, const std::string& key) { return var::getElement(tableVar, key); }
+void setElement(var& tableVar, const std::string& key, const var& value) { var::setElement(tableVar, key, value); }
+size_t len(const var& varObj) { return var::len(varObj); }
+var range(int start, int end, int step) { return var::range(start, end, step); }
+var range(int end) { return var::range(end); }
+var slice(const var& arrayVar, int start, int end, int step) { return var::slice(arrayVar, start, end, step); }
+
+// Move-only free function forms
+void setElement(var& arrayVar, size_t index, var&& value) { var::setElement(arrayVar, index, std::move(value)); }
+void appendElement(var& arrayVar, var&& value) { var::appendElement(arrayVar, std::move(value)); }
+void setElement(var& tableVar, const std::string& key, var&& value) { var::setElement(tableVar, key, std::move(value)); }
+var getElement(const var& tableVar, PropertyCache& cache) { return var::getElement(tableVar, cache); }
 
 // Utility functions
 size_t var::len(const var& varObj) {
     if (varObj.isArray()) return varObj.getArray().size();
     if (varObj.isTable()) return varObj.getTable().size();
+    if (varObj.isOrderedTable()) return varObj.getOrderedTable().size();
+    if (varObj.isRecord()) return varObj.getRecord().size();
     throw std::runtime_error("var is neither Array nor Table");
 }
 
+var var::toRecord(const var& tableVar) {
+    if (tableVar.isRecord()) return tableVar;
+    if (tableVar.isOrderedTable()) {
+        const OrderedTable& tbl = tableVar.getOrderedTable();
+        Record rec(Shape::forKeys(tbl.keys()));
+        for (size_t i = 0; i < tbl.size(); ++i) rec.valueAt(i) = tbl.valueAt(i);
+        return var(std::move(rec));
+    }
+    if (!tableVar.isTable()) throw std::runtime_error("var is not a Table");
+
+    // Sorted keys give every Table with the same key set the same shape
+    const Table& tbl = tableVar.getTable();
+    std::vector<const std::pair<const VarString, var>*> entries;
+    entries.reserve(tbl.size());
+    for (const auto& entry : tbl) entries.push_back(&entry);
+    std::sort(entries.begin(), entries.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    std::vector<std::string> keys;
+    keys.reserve(entries.size());
+    for (const auto* entry : entries) keys.push_back(entry->first.str());
+    Record rec(Shape::forKeys(keys));
+    for (size_t i = 0; i < entries.size(); ++i) rec.valueAt(i) = entries[i]->second;
+    return var(std::move(rec));
+}
+
+var toRecord(const var& tableVar) {
+    return var::toRecord(tableVar);
+}
+
 var var::range(int start, int end, int step) {
     if (step == 0) throw std::invalid_argument("Step cannot be zero");
     Array arr;
+    long long span = step > 0 ? static_cast<long long>(end) - start : static_cast<long long>(start) - end;
+    long long stride = step > 0 ? step : -static_cast<long long>(step);
+    if (span > 0) arr.reserve(static_cast<size_t>((span + stride - 1) / stride));
     if (step > 0) {
         for (int i = start; i < end; i += step) {
             arr.emplace_back(makeInt(i));
@@ -528,7 +875,7 @@ var var::range(int start, int end, int step) {
             arr.emplace_back(makeInt(i));
         }
     }
-    return var(arr);
+    return var(std::move(arr));
 }
 
 var var::range(int end) {
@@ -551,6 +898,19 @@ var var::slice(const var& arrayVar, int start, int end, int step) {
 
     if (step == 0) throw std::invalid_argument("Step cannot be zero");
 
+    // Reserve the number of elements the loops below take
+    const long long size = static_cast<long long>(arr.size());
+    long long count = 0;
+    if (step > 0) {
+        long long last = std::min<long long>(end, size);
+        if (start < last) count = (last - start + step - 1) / step;
+    }
+    else {
+        long long last = std::max<long long>(end, -1);
+        if (start > last) count = (start - last - step - 1) / -static_cast<long long>(step);
+    }
+    slicedArr.reserve(static_cast<size_t>(count));
+
     if (step > 0) {
         for (int i = start; i < end && i < static_cast<int>(arr.size()); i += step) {
             slicedArr.emplace_back(arr[i]);
@@ -562,5 +922,423 @@ var var::slice(const var& arrayVar, int start, int end, int step) {
         }
     }
 
-    return var(slicedArr);
+    return var(std::move(slicedArr));
+}
+
+// ------------------------ Builders ------------------------
+
+ArrayBuilder& ArrayBuilder::append(const var& value) {
+    items_.emplace_back(value);
+    return *this;
+}
+
+ArrayBuilder& ArrayBuilder::append(var&& value) {
+    items_.emplace_back(std::move(value));
+    return *this;
+}
+
+var ArrayBuilder::build() {
+    var result(std::move(items_));
+    items_ = Array();
+    return result;
+}
+
+TableBuilder& TableBuilder::set(const std::string& key, const var& value) {
+    entries_.insert_or_assign(key, value);
+    return *this;
+}
+
+TableBuilder& TableBuilder::set(std::string&& key, var&& value) {
+    entries_.insert_or_assign(std::move(key), std::move(value));
+    return *this;
+}
+
+var TableBuilder::build() {
+    var result(std::move(entries_));
+    entries_ = Table();
+    return result;
+}
+
+// ------------------------ OrderedTable Implementation ------------------------
+
+namespace {
+    constexpr size_t kOrderedTableMinIndex = 8;
+
+    uint32_t hashTag(size_t hash) {
+        return static_cast<uint32_t>(hash >> 32) ^ static_cast<uint32_t>(hash);
+    }
+}
+
+OrderedTable::OrderedTable(std::initializer_list<std::pair<std::string, var>> entries) {
+    reserve(entries.size());
+    for (const auto& [key, value] : entries) {
+        insert_or_assign(key, value);
+    }
+}
+
+OrderedTable::OrderedTable(const OrderedTable& other) : keys_(other.keys_), values_(other.values_) {
+    if (size_t capacity = other.indexCapacity()) {
+        index_.reset(new Slot[capacity + 1]);
+        std::copy_n(other.index_.get(), capacity + 1, index_.get());
+    }
+}
+
+OrderedTable& OrderedTable::operator=(const OrderedTable& other) {
+    if (this != &other) *this = OrderedTable(other);
+    return *this;
+}
+
+void OrderedTable::reserve(size_t count) {
+    keys_.reserve(count);
+    values_.reserve(count);
+    // Keep the index at most 3/4 full
+    size_t capacity = kOrderedTableMinIndex;
+    while (capacity * 3 < count * 4) capacity *= 2;
+    if (capacity > indexCapacity()) rebuildIndex(capacity);
+}
+
+void OrderedTable::clear() {
+    keys_.clear();
+    values_.clear();
+    index_.reset();
+}
+
+bool OrderedTable::contains(std::string_view key) const {
+    return find(key) != nullptr;
+}
+
+var* OrderedTable::find(std::string_view key) {
+    size_t position = lookup(key, std::hash<std::string_view>{}(key));
+    return position < values_.size() ? &values_[position] : nullptr;
+}
+
+const var* OrderedTable::find(std::string_view key) const {
+    size_t position = lookup(key, std::hash<std::string_view>{}(key));
+    return position < values_.size() ? &values_[position] : nullptr;
+}
+
+var& OrderedTable::at(std::string_view key) {
+    var* found = find(key);
+    if (!found) throw std::out_of_range("Key not found");
+    return *found;
+}
+
+const var& OrderedTable::at(std::string_view key) const {
+    const var* found = find(key);
+    if (!found) throw std::out_of_range("Key not found");
+    return *found;
+}
+
+var& OrderedTable::operator[](const std::string& key) {
+    size_t hash = std::hash<std::string_view>{}(key);
+    size_t position = lookup(key, hash);
+    if (position < values_.size()) return values_[position];
+    return values_[append(std::string(key), hash)];
+}
+
+bool OrderedTable::insert_or_assign(const std::string& key, const var& value) {
+    size_t hash = std::hash<std::string_view>{}(key);
+    size_t position = lookup(key, hash);
+    if (position < values_.size()) {
+        values_[position] = value;
+        return false;
+    }
+    // The key is only copied once it is known to be new. value may refer into
+    // values_, so it is copied before append can reallocate it
+    var copy(value);
+    values_[append(std::string(key), hash)] = std::move(copy);
+    return true;
+}
+
+bool OrderedTable::insert_or_assign(const std::string& key, var&& value) {
+    size_t hash = std::hash<std::string_view>{}(key);
+    size_t position = lookup(key, hash);
+    if (position < values_.size()) {
+        values_[position] = std::move(value);
+        return false;
+    }
+    var moved(std::move(value));
+    values_[append(std::string(key), hash)] = std::move(moved);
+    return true;
+}
+
+bool OrderedTable::insert_or_assign(std::string&& key, var&& value) {
+    size_t hash = std::hash<std::string_view>{}(key);
+    size_t position = lookup(key, hash);
+    if (position < values_.size()) {
+        values_[position] = std::move(value);
+        return false;
+    }
+    var moved(std::move(value));
+    values_[append(std::move(key), hash)] = std::move(moved);
+    return true;
+}
+
+bool OrderedTable::erase(std::string_view key) {
+    size_t position = lookup(key, std::hash<std::string_view>{}(key));
+    if (position >= keys_.size()) return false;
+    keys_.erase(keys_.begin() + position);
+    values_.erase(values_.begin() + position);
+    // Entry positions after the erased one shifted, so the index is rebuilt
+    rebuildIndex(indexCapacity());
+    return true;
+}
+
+// Returns the entry position for key, or size() if it is missing
+size_t OrderedTable::lookup(std::string_view key, size_t hash) const {
+    const size_t capacity = indexCapacity();
+    if (capacity == 0) return keys_.size();
+    const size_t mask = capacity - 1;
+    const uint32_t tag = hashTag(hash);
+    const Slot* table = slots();
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        const Slot& s = table[slot];
+        if (s.entry == 0) return keys_.size();
+        if (s.tag == tag && keys_[s.entry - 1] == key) return s.entry - 1;
+    }
+}
+
+// Appends a new entry with a null value and indexes it; key must not be present
+size_t OrderedTable::append(std::string&& key, size_t hash) {
+    if ((keys_.size() + 1) * 4 > indexCapacity() * 3) {
+        rebuildIndex(indexCapacity() == 0 ? kOrderedTableMinIndex : indexCapacity() * 2);
+    }
+    const size_t position = keys_.size();
+    keys_.emplace_back(std::move(key));
+    values_.emplace_back();
+
+    const size_t mask = indexCapacity() - 1;
+    Slot* table = slots();
+    size_t slot = hash & mask;
+    while (table[slot].entry != 0) slot = (slot + 1) & mask;
+    table[slot] = { static_cast<uint32_t>(position + 1), hashTag(hash) };
+    return position;
+}
+
+void OrderedTable::rebuildIndex(size_t capacity) {
+    if (capacity == 0) {
+        index_.reset();
+        return;
+    }
+    index_.reset(new Slot[capacity + 1]);
+    index_[0].entry = static_cast<uint32_t>(capacity);
+    Slot* table = slots();
+    const size_t mask = capacity - 1;
+    for (size_t position = 0; position < keys_.size(); ++position) {
+        size_t hash = std::hash<std::string_view>{}(keys_[position]);
+        size_t slot = hash & mask;
+        while (table[slot].entry != 0) slot = (slot + 1) & mask;
+        table[slot] = { static_cast<uint32_t>(position + 1), hashTag(hash) };
+    }
+}
+
+// ------------------------ Shape and Record Implementation ------------------------
+
+namespace {
+    // Shapes up to this many keys are searched linearly instead of through a hash index
+    constexpr size_t kShapeLinearSearch = 8;
+
+    // Shapes with this many keys add further keys as dictionary shapes. Each
+    // transition copies its parent's keys, so the tree is kept to narrow shapes.
+    constexpr size_t kShapeMaxTransitionKeys = 64;
+
+    // Per-thread cache of recent transitions, so growing a Record along a known
+    // path takes no lock. Entries are checked against the parent and key on use.
+    constexpr size_t kTransitionCacheSize = 64;
+    thread_local std::weak_ptr<const Shape> transitionCache[kTransitionCacheSize];
+
+    size_t transitionCacheSlot(const Shape* parent, const std::string& key) {
+        size_t h = std::hash<std::string>{}(key) ^ (reinterpret_cast<uintptr_t>(parent) >> 4);
+        return h % kTransitionCacheSize;
+    }
+}
+
+const std::shared_ptr<const Shape>& Shape::root() {
+    static const std::shared_ptr<const Shape> empty(new Shape());
+    return empty;
+}
+
+std::shared_ptr<const Shape> Shape::forKeys(const std::vector<std::string>& keys) {
+    std::shared_ptr<const Shape> shape = root();
+    for (const std::string& key : keys) {
+        if (shape->slotOf(key) != npos) throw std::invalid_argument("Duplicate key in shape");
+        extend(shape, key);
+    }
+    return shape;
+}
+
+size_t Shape::slotOf(std::string_view key) const {
+    if (keys_.size() <= kShapeLinearSearch) {
+        for (size_t slot = 0; slot < keys_.size(); ++slot) {
+            if (keys_[slot] == key) return slot;
+        }
+        return npos;
+    }
+    auto it = index_.find(key);
+    return it == index_.end() ? npos : it->second;
+}
+
+std::shared_ptr<const Shape> Shape::withKey(const std::string& key) const {
+    if (dictionary_ || keys_.size() >= kShapeMaxTransitionKeys) {
+        std::shared_ptr<Shape> fresh(new Shape());
+        fresh->dictionary_ = true;
+        fresh->assignKeys(*this, key);
+        return fresh;
+    }
+
+    std::weak_ptr<const Shape>& cached = transitionCache[transitionCacheSlot(this, key)];
+    {
+        // Both shapes are alive here, so a matching parent pointer is this shape
+        std::shared_ptr<const Shape> child = cached.lock();
+        if (child && child->parent_.get() == this && child->keys_.back() == key) return child;
+    }
+
+    std::shared_ptr<const Shape> child;
+    {
+        std::lock_guard<std::mutex> lock(transitionsMutex_);
+        std::weak_ptr<const Shape>& transition = transitions_[key];
+        child = transition.lock();
+        if (!child) {
+            std::shared_ptr<Shape> fresh(new Shape());
+            fresh->parent_ = shared_from_this();
+            fresh->assignKeys(*this, key);
+            transition = fresh;
+            child = std::move(fresh);
+        }
+    }
+    cached = child;
+    return child;
+}
+
+void Shape::extend(std::shared_ptr<const Shape>& shape, const std::string& key) {
+    if (shape->dictionary_ && shape.use_count() == 1) {
+        // No other Record or cache can see this shape; pairs with the release of the last other owner
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const_cast<Shape&>(*shape).appendKey(key);
+        return;
+    }
+    shape = shape->withKey(key);
+}
+
+void Shape::assignKeys(const Shape& other, const std::string& key) {
+    keys_.reserve(other.keys_.size() + 1);
+    keys_ = other.keys_;
+    index_ = other.index_;
+    appendKey(key);
+}
+
+// Leaves the shape unchanged if it throws
+void Shape::appendKey(const std::string& key) {
+    keys_.push_back(key);
+    if (keys_.size() <= kShapeLinearSearch) return;
+    try {
+        if (index_.empty()) {
+            index_.reserve(keys_.size());
+            for (size_t slot = 0; slot < keys_.size(); ++slot) index_.emplace(keys_[slot], static_cast<uint32_t>(slot));
+        }
+        else {
+            index_.emplace(key, static_cast<uint32_t>(keys_.size() - 1));
+        }
+    }
+    catch (...) {
+        keys_.pop_back();
+        if (keys_.size() == kShapeLinearSearch) index_.clear();
+        throw;
+    }
+}
+
+Shape::~Shape() {
+    if (!parent_) return;
+    std::lock_guard<std::mutex> lock(parent_->transitionsMutex_);
+    // The parent may already have replaced this entry with a live child
+    auto it = parent_->transitions_.find(keys_.back());
+    if (it != parent_->transitions_.end() && it->second.expired()) parent_->transitions_.erase(it);
+}
+
+Record::Record() : shape_(Shape::root()) {}
+
+Record::Record(std::shared_ptr<const Shape> shape) : shape_(std::move(shape)), slots_(shape_->size()) {}
+
+Record::Record(Record&& other) noexcept
+    : shape_(std::exchange(other.shape_, Shape::root())), slots_(std::move(other.slots_)) {
+    other.slots_.clear();
+}
+
+Record& Record::operator=(Record&& other) noexcept {
+    if (this != &other) {
+        shape_ = std::exchange(other.shape_, Shape::root());
+        slots_ = std::move(other.slots_);
+        other.slots_.clear();
+    }
+    return *this;
+}
+
+var* Record::find(std::string_view key) {
+    size_t slot = shape_->slotOf(key);
+    return slot == Shape::npos ? nullptr : &slots_[slot];
+}
+
+const var* Record::find(std::string_view key) const {
+    size_t slot = shape_->slotOf(key);
+    return slot == Shape::npos ? nullptr : &slots_[slot];
+}
+
+var& Record::at(std::string_view key) {
+    var* found = find(key);
+    if (!found) throw std::out_of_range("Key not found");
+    return *found;
+}
+
+const var& Record::at(std::string_view key) const {
+    const var* found = find(key);
+    if (!found) throw std::out_of_range("Key not found");
+    return *found;
+}
+
+bool Record::insert_or_assign(const std::string& key, const var& value) {
+    return insert_or_assign(key, var(value));
+}
+
+bool Record::insert_or_assign(const std::string& key, var&& value) {
+    size_t slot = shape_->slotOf(key);
+    if (slot != Shape::npos) {
+        slots_[slot] = std::move(value);
+        return false;
+    }
+    Shape::extend(shape_, key);
+    slots_.emplace_back(std::move(value));
+    return true;
+}
+
+bool Record::erase(std::string_view key) {
+    size_t slot = shape_->slotOf(key);
+    if (slot == Shape::npos) return false;
+    std::vector<std::string> keys = shape_->keys();
+    keys.erase(keys.begin() + slot);
+    shape_ = Shape::forKeys(keys);
+    slots_.erase(slots_.begin() + slot);
+    return true;
+}
+
+const var* PropertyCache::find(const var& object) {
+    if (!object.isRecord()) return object.find(key_);
+
+    const Record& rec = object.getRecord();
+    if (rec.shape() != shape_) {
+        // Miss: remember this shape's slot (npos if it lacks the key)
+        shape_ = rec.shape();
+        slot_ = shape_->slotOf(key_);
+    }
+    return slot_ == Shape::npos ? nullptr : &rec.valueAt(slot_);
+}
+
+// ------------------------ Serialization ------------------------
+
+Generator<std::string_view> var::serialize(const var& varObj, size_t chunkSize) {
+    if (chunkSize == 0) throw std::invalid_argument("Chunk size cannot be zero");
+    return serializeChunks(varObj, chunkSize);
+}
+
+Generator<std::string_view> serialize(const var& varObj, size_t chunkSize) {
+    return var::serialize(varObj, chunkSize);
 }
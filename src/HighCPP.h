@@ -9,13 +9,227 @@
 #include <stdexcept>
 #include <any>
 #include <type_traits>
+#include <initializer_list>
+#include <cstdint>
+#include <string_view>
+#include <mutex>
+
+#include "Generator.h"
+#include "VarString.h"
 
 // Forward declaration for nested structures
 struct var;
+class ColumnarTable;
+struct CsvOptions;
+enum class RowKind;
 
 // Define Array and Table using vectors and unordered_maps of var
 using Array = std::vector<var>;
-using Table = std::unordered_map<std::string, var>;
+using Table = std::unordered_map<VarString, var, VarStringHash, VarStringEqual>;
+
+// Iterates (key, value) pairs of keyed containers that expose keyAt/valueAt
+template <typename Owner, typename ValueRef>
+class EntryIterator;
+
+// Insertion-ordered table. Keys and values live in dense parallel vectors so
+// iteration is contiguous and deterministic; a compact open-addressing index
+// maps each key to its entry position. The index is a single pointer so that
+// OrderedTable is no larger than Table and does not grow var.
+class OrderedTable {
+public:
+    using iterator = EntryIterator<OrderedTable, var&>;
+    using const_iterator = EntryIterator<const OrderedTable, const var&>;
+
+    OrderedTable() = default;
+    OrderedTable(std::initializer_list<std::pair<std::string, var>> entries);
+    OrderedTable(const OrderedTable& other);
+    OrderedTable(OrderedTable&& other) noexcept = default;
+    OrderedTable& operator=(const OrderedTable& other);
+    OrderedTable& operator=(OrderedTable&& other) noexcept = default;
+
+    size_t size() const { return keys_.size(); }
+    bool empty() const { return keys_.empty(); }
+    void reserve(size_t count);
+    void clear();
+
+    // Lookup by any string-like key without allocating; find() returns nullptr when the key is missing
+    bool contains(std::string_view key) const;
+    var* find(std::string_view key);
+    const var* find(std::string_view key) const;
+    var& at(std::string_view key);
+    const var& at(std::string_view key) const;
+
+    // Inserts a null value at the end if the key is missing
+    var& operator[](const std::string& key);
+
+    // Returns true if a new entry was appended, false if an existing one was replaced
+    bool insert_or_assign(const std::string& key, const var& value);
+    bool insert_or_assign(const std::string& key, var&& value);
+    bool insert_or_assign(std::string&& key, var&& value);
+
+    // Keeps the order of the remaining entries; O(n)
+    bool erase(std::string_view key);
+
+    // Positional access in insertion order
+    const std::string& keyAt(size_t index) const { return keys_[index]; }
+    var& valueAt(size_t index);
+    const var& valueAt(size_t index) const;
+    const std::vector<std::string>& keys() const { return keys_; }
+    const std::vector<var>& values() const { return values_; }
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+    // Index slot: entry is position + 1 (0 marks an empty slot), tag is the upper hash bits
+    struct Slot {
+        uint32_t entry = 0;
+        uint32_t tag = 0;
+    };
+
+    size_t lookup(std::string_view key, size_t hash) const;
+    size_t append(std::string&& key, size_t hash);
+    void rebuildIndex(size_t capacity);
+
+    // Slot 0 of index_ is a header whose entry holds the capacity; the table follows it
+    size_t indexCapacity() const { return index_ ? index_[0].entry : 0; }
+    Slot* slots() const { return index_.get() + 1; }
+
+    std::vector<std::string> keys_;
+    std::vector<var> values_;
+    std::unique_ptr<Slot[]> index_;
+};
+
+// Hidden-class layout shared by Records that have the same keys in the same
+// order. Shapes are immutable and interned through transitions: adding a key to
+// a shape always returns the same child, so Records built alike share one
+// key-to-slot layout. A child keeps its parent alive, but parents only hold
+// their transitions weakly, so a shape is freed once no Record or cache uses it.
+// Past 64 keys a shape leaves the transition tree and becomes a dictionary
+// shape: it is not shared through transitions, and one that a single Record
+// holds grows in place, so building a wide Record stays linear.
+class Shape : public std::enable_shared_from_this<Shape> {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // The empty shape every Record starts from
+    static const std::shared_ptr<const Shape>& root();
+
+    // Shape with the given keys, in order, reached from the root
+    static std::shared_ptr<const Shape> forKeys(const std::vector<std::string>& keys);
+
+    size_t size() const { return keys_.size(); }
+    const std::vector<std::string>& keys() const { return keys_; }
+    const std::string& keyAt(size_t slot) const { return keys_[slot]; }
+
+    // Returns the slot holding key, or npos
+    size_t slotOf(std::string_view key) const;
+
+    // Child shape with key appended; key must not already be present
+    std::shared_ptr<const Shape> withKey(const std::string& key) const;
+
+    // Replaces shape with shape->withKey(key), but a dictionary shape nothing else holds is extended in place
+    static void extend(std::shared_ptr<const Shape>& shape, const std::string& key);
+
+    // True for shapes outside the transition tree
+    bool isDictionary() const { return dictionary_; }
+
+    // Removes this shape's expired entry from its parent's transitions
+    ~Shape();
+
+private:
+    // Transparent, so slotOf can search index_ with a string_view
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const noexcept { return std::hash<std::string_view>()(key); }
+    };
+
+    Shape() = default;
+
+    // Copies keys and index from other, then appends key
+    void assignKeys(const Shape& other, const std::string& key);
+    void appendKey(const std::string& key);
+
+    std::vector<std::string> keys_;
+    std::unordered_map<std::string, uint32_t, KeyHash, std::equal_to<>> index_; // Only built for larger shapes
+    bool dictionary_ = false;
+
+    std::shared_ptr<const Shape> parent_;
+    mutable std::mutex transitionsMutex_;
+    mutable std::unordered_map<std::string, std::weak_ptr<const Shape>> transitions_;
+};
+
+// Table mode for records with common key sets: keys live in a shared Shape and
+// the Record only stores a dense array of values, one slot per key.
+class Record {
+public:
+    using iterator = EntryIterator<Record, var&>;
+    using const_iterator = EntryIterator<const Record, const var&>;
+
+    Record();
+    explicit Record(std::shared_ptr<const Shape> shape); // All slots start null
+
+    // A moved-from Record is left empty with the root shape
+    Record(const Record& other) = default;
+    Record(Record&& other) noexcept;
+    Record& operator=(const Record& other) = default;
+    Record& operator=(Record&& other) noexcept;
+
+    const std::shared_ptr<const Shape>& shape() const { return shape_; }
+    size_t size() const { return slots_.size(); }
+    bool empty() const { return slots_.empty(); }
+
+    // Lookup by any string-like key without allocating; find() returns nullptr when the key is missing
+    bool contains(std::string_view key) const { return shape_->slotOf(key) != Shape::npos; }
+    var* find(std::string_view key);
+    const var* find(std::string_view key) const;
+    var& at(std::string_view key);
+    const var& at(std::string_view key) const;
+
+    // New keys transition the Record to the child shape. Returns true if a key was added.
+    bool insert_or_assign(const std::string& key, const var& value);
+    bool insert_or_assign(const std::string& key, var&& value);
+
+    // Rebuilds the shape without key; O(n)
+    bool erase(std::string_view key);
+
+    // Positional access by slot
+    const std::string& keyAt(size_t slot) const { return shape_->keyAt(slot); }
+    var& valueAt(size_t slot);
+    const var& valueAt(size_t slot) const;
+    const std::vector<var>& values() const { return slots_; }
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+    std::shared_ptr<const Shape> shape_;
+    std::vector<var> slots_;
+};
+
+// Inline cache for repeated lookups of one key at one call site. It remembers
+// the last Shape seen and the key's slot in it, so Records of that shape skip
+// the key search. Non-Record tables fall back to a normal lookup. The cache
+// holds its shape, so a freed shape's address can never produce a false hit.
+// A cache must not be shared between threads; see HIGHCPP_GET_ELEMENT.
+class PropertyCache {
+public:
+    explicit PropertyCache(std::string key) : key_(std::move(key)) {}
+
+    const std::string& key() const { return key_; }
+
+    // Returns nullptr if the key is missing; throws if object is not a table
+    const var* find(const var& object);
+
+private:
+    std::string key_;
+    std::shared_ptr<const Shape> shape_;
+    size_t slot_ = Shape::npos;
+};
 
 // Enum for var types
 enum class varType {
@@ -25,10 +239,12 @@ enum class varType {
     String,
     Array,
     Table,
+    OrderedTable,   // Insertion-ordered Table
+    Record,         // Shape-based Table
     Pointer,        // Pointer to var (shared_ptr<var>)
     RawPointer,     // Raw Pointer (void*)
     SharedPointer,  // std::shared_ptr<void>
-    UniquePointer,  // std::unique_ptr<void, std::default_delete<void>>
+    UniquePointer,  // std::unique_ptr<void> with a type-erased deleter
     WeakPointer,    // std::weak_ptr<void>
     Object          // Renamed from Custom for consistency
 };
@@ -40,46 +256,93 @@ struct is_weak_ptr : std::false_type {};
 template <typename T>
 struct is_weak_ptr<std::weak_ptr<T>> : std::true_type {};
 
+// Type trait to check if T already has a dedicated var constructor, so that
+// non-const lvalues of these types are not swallowed by the std::any template
+template <typename T>
+struct is_var_alternative : std::bool_constant<
+    std::is_same_v<T, VarString> ||
+    std::is_same_v<T, std::string> ||
+    std::is_same_v<T, std::string_view> ||
+    std::is_same_v<T, Array> ||
+    std::is_same_v<T, Table> ||
+    std::is_same_v<T, OrderedTable> ||
+    std::is_same_v<T, Record> ||
+    std::is_same_v<T, std::shared_ptr<var>> ||
+    std::is_same_v<T, std::shared_ptr<const var>> ||
+    std::is_same_v<T, std::shared_ptr<void>> ||
+    std::is_same_v<T, std::unique_ptr<void, void (*)(void*)>> ||
+    std::is_same_v<T, std::any>> {};
+
+// True for the lazy elementwise expressions of Operators.h, which convert to var
+// rather than being stored as Objects
+template <typename T>
+struct is_var_expr : std::false_type {};
+
 // Define the var structure
 struct var {
     // Define the variant to hold different types
     using Pointer = std::shared_ptr<var>;
 
+    // Immutable node shared between trees, created by InternPool and var::dedupe.
+    // Only containers are shared this way; Strings share their VarString buffers.
+    // Reads see straight through it: isArray()/getArray() const etc. behave as
+    // for the wrapped value, while the non-const getters first replace it with a
+    // private copy (copy-on-write).
+    using Shared = std::shared_ptr<const var>;
+
+    // Owning pointer to an object of any type; the deleter remembers the real type
+    using UniquePointer = std::unique_ptr<void, void (*)(void*)>;
+
     std::variant<
         std::monostate,                 // Represents 'null' or 'undefined'
         int,                            // Integer
         double,                         // Double
-        std::string,                    // String
+        VarString,                      // String (inline or shared buffer)
         Array,                          // Dynamic Array
         Table,                          // Dynamic Table (Dictionary)
         Pointer,                        // Pointer to var for nested structures
         std::any,                       // Custom type for user-defined classes and pointers
         void*,                          // Raw Pointer
         std::shared_ptr<void>,          // Shared Pointer
-        std::unique_ptr<void, std::default_delete<void>>, // Unique Pointer
-        std::weak_ptr<void>             // Weak Pointer
+        UniquePointer,                  // Unique Pointer
+        std::weak_ptr<void>,            // Weak Pointer
+        OrderedTable,                   // Insertion-ordered Table
+        Record,                         // Shape-based Table
+        Shared                          // Interned immutable node
     > value;
 
     // Constructors
     var();
     var(int v);
     var(double v);
+    var(const VarString& v);
+    var(VarString&& v);
     var(const std::string& v);
-    var(std::string&& v);
+    var(std::string_view v);
     var(const char* v);
     var(const Array& v);
     var(Array&& v);
     var(const Table& v);
     var(Table&& v);
+    var(const OrderedTable& v);
+    var(OrderedTable&& v);
+    var(const Record& v);
+    var(Record&& v);
     var(const Pointer& v);
     var(Pointer&& v);
+    var(const Shared& v);
+    var(Shared&& v);
     var(const std::any& v);
     var(std::any&& v);
     var(void* v);
+    var(std::shared_ptr<void> v);
+    var(UniquePointer&& v);
 
     // Template constructors
     template <typename T, typename = std::enable_if_t<
         !std::is_same_v<std::decay_t<T>, var> &&
+        !is_var_alternative<std::decay_t<T>>::value &&
+        !is_var_expr<std::decay_t<T>>::value &&
         !std::is_pointer_v<std::decay_t<T>> &&
         !is_weak_ptr<std::decay_t<T>>::value
         >>
@@ -95,24 +358,39 @@ struct var {
     template <typename T, typename = std::enable_if_t<is_weak_ptr<std::decay_t<T>>::value>>
     var(const T& wp);
 
+    // Lazy expressions (see Operators.h) are evaluated when they become a var
+    template <typename E, typename = std::enable_if_t<is_var_expr<E>::value>, typename = void>
+    var(const E& expr) : var(expr.evaluate()) {}
+
     // Copy and Move Constructors
     var(const var& other);
     var(var&& other) noexcept = default;
 
+    // Destructor; nested containers are torn down iteratively
+    ~var();
+
     // Copy and Move Assignment Operators
     var& operator=(const var& other);
     var& operator=(var&& other) noexcept = default;
 
+    template <typename E, typename = std::enable_if_t<is_var_expr<E>::value>, typename = void>
+    var& operator=(const E& expr) { return *this = expr.evaluate(); }
+
     // Assignment Operators for different types
     var& operator=(int v);
     var& operator=(double v);
+    var& operator=(const VarString& v);
+    var& operator=(VarString&& v);
     var& operator=(const std::string& v);
-    var& operator=(std::string&& v);
     var& operator=(const char* v);
     var& operator=(const Array& v);
     var& operator=(Array&& v);
     var& operator=(const Table& v);
     var& operator=(Table&& v);
+    var& operator=(const OrderedTable& v);
+    var& operator=(OrderedTable&& v);
+    var& operator=(const Record& v);
+    var& operator=(Record&& v);
     var& operator=(const Pointer& v);
     var& operator=(Pointer&& v);
     var& operator=(const std::any& v);
@@ -121,6 +399,8 @@ struct var {
     // Template assignment operators
     template <typename T, typename = std::enable_if_t<
         !std::is_same_v<std::decay_t<T>, var> &&
+        !is_var_alternative<std::decay_t<T>>::value &&
+        !is_var_expr<std::decay_t<T>>::value &&
         !std::is_pointer_v<std::decay_t<T>> &&
         !is_weak_ptr<std::decay_t<T>>::value
         >>
@@ -142,6 +422,8 @@ struct var {
     bool isString() const;
     bool isArray() const;
     bool isTable() const;
+    bool isOrderedTable() const;
+    bool isRecord() const;
     bool isPointer() const;
     bool isRawPointer() const;
     bool isSharedPointer() const;
@@ -149,25 +431,48 @@ struct var {
     bool isWeakPointer() const;
     bool IsObject() const; // Renamed from isCustom()
     bool isNull() const;
+    bool isShared() const;
+    bool isNumber() const; // Int or Double
+    bool isKeyed() const; // Table, OrderedTable or Record
 
     // Getters with type safety
     int getInt() const;
     double getDouble() const;
-    const std::string& getString() const;
-    std::string& getString();
+    const VarString& getString() const; // Strings are immutable; assign a new value to change one
     const Array& getArray() const;
     Array& getArray();
     const Table& getTable() const;
     Table& getTable();
+    const OrderedTable& getOrderedTable() const;
+    OrderedTable& getOrderedTable();
+    const Record& getRecord() const;
+    Record& getRecord();
     const Pointer& getPointer() const;
     Pointer& getPointer();
     const std::any& getObject() const; // Renamed from getCustom()
     std::any& getObject(); // Renamed from getCustom()
     void* getRawPointer() const;
     std::shared_ptr<void> getSharedPointer() const;
-    std::unique_ptr<void, std::default_delete<void>>& getUniquePointer();
-    const std::unique_ptr<void, std::default_delete<void>>& getUniquePointer() const;
+    UniquePointer& getUniquePointer();
+    const UniquePointer& getUniquePointer() const;
     std::weak_ptr<void> getWeakPointer() const;
+    const Shared& getShared() const;
+
+    // Int or Double as a double; throws std::bad_variant_access for other types
+    double toDouble() const;
+
+    // Keyed access shared by every table kind. find returns nullptr for a missing
+    // key; both throw std::runtime_error if the var is not a Table, OrderedTable or Record.
+    const var* find(std::string_view key) const;
+    var* find(std::string_view key);
+
+    // Calls fn(std::string_view key, const var& value) for every entry. If fn returns
+    // bool, false stops the walk and forEachEntry returns false.
+    template <typename Fn>
+    bool forEachEntry(Fn&& fn) const;
+
+    // Turns a Shared node back into a private value; its children stay shared
+    void unshare();
 
     // Helper to get type as string
     std::string typeOf() const;
@@ -189,6 +494,10 @@ struct var {
     static var makeArray(Array&& arr);
     static var makeTable(const Table& tbl);
     static var makeTable(Table&& tbl);
+    static var makeOrderedTable(const OrderedTable& tbl);
+    static var makeOrderedTable(OrderedTable&& tbl);
+    static var makeRecord(const Record& rec);
+    static var makeRecord(Record&& rec);
     static var makePointer(const var& varObj);
     static var makePointer(var&& varObj);
     static var makeCustom(const std::any& customObj);
@@ -199,13 +508,21 @@ struct var {
     static var newArray(Array&& arr);
     static var getElement(const var& arrayVar, size_t index);
     static void setElement(var& arrayVar, size_t index, const var& value);
+    static void setElement(var& arrayVar, size_t index, var&& value);
     static void appendElement(var& arrayVar, const var& value);
+    static void appendElement(var& arrayVar, var&& value);
 
-    // Table functions
+    // Table functions (getElement/setElement/len also accept OrderedTable and Record)
     static var newTable(const Table& tbl);
     static var newTable(Table&& tbl);
+    static var newOrderedTable(const OrderedTable& tbl);
+    static var newOrderedTable(OrderedTable&& tbl);
+    static var newRecord(const Record& rec);
+    static var newRecord(Record&& rec);
     static var getElement(const var& tableVar, const std::string& key);
+    static var getElement(const var& tableVar, PropertyCache& cache);
     static void setElement(var& tableVar, const std::string& key, const var& value);
+    static void setElement(var& tableVar, const std::string& key, var&& value);
 
     // Utility functions
     static size_t len(const var& varObj);
@@ -213,6 +530,32 @@ struct var {
     static var range(int end);
     static var slice(const var& arrayVar, int start, int end, int step = 1);
 
+    // Converts a Table (keys sorted, so equal key sets share a shape) or an
+    // OrderedTable (insertion order kept) into a Record
+    static var toRecord(const var& tableVar);
+
+    // Columnar conversion (see Columnar.h): Array of row Tables <-> one packed column per key
+    static ColumnarTable toColumnar(const var& rows);
+    static var fromColumnar(const ColumnarTable& columns, RowKind kind);
+
+    // CSV ingestion (see Csv.h): the file is split on row boundaries and the
+    // chunks are parsed in parallel; rows come back in file order
+    static var readCsv(const std::string& path);
+    static var readCsv(const std::string& path, const CsvOptions& options);
+    static ColumnarTable readCsvColumnar(const std::string& path);
+    static ColumnarTable readCsvColumnar(const std::string& path, const CsvOptions& options);
+
+    // Serialization: yields the operator<< text in chunks of chunkSize bytes (the
+    // last chunk may be shorter). Each chunk is only valid until the generator is
+    // resumed, and varObj must outlive the generator and stay unmodified. Besides
+    // the pending chunk, the generator holds one frame per open container.
+    static Generator<std::string_view> serialize(const var& varObj, size_t chunkSize = 64 * 1024);
+
+    // Deduplication (see Intern.h): points repeated long strings at one buffer and
+    // replaces repeated subtrees of tree with Shared nodes. Returns the estimated
+    // heap bytes saved.
+    static size_t dedupe(var& tree);
+
     // Utility functions for smart pointers
     template <typename T>
     static var makeSmartPointer(const std::shared_ptr<T>& ptr);
@@ -239,6 +582,10 @@ var makeArray(const Array& arr);
 var makeArray(Array&& arr);
 var makeTable(const Table& tbl);
 var makeTable(Table&& tbl);
+var makeOrderedTable(const OrderedTable& tbl);
+var makeOrderedTable(OrderedTable&& tbl);
+var makeRecord(const Record& rec);
+var makeRecord(Record&& rec);
 var makePointer(const var& varObj);
 var makePointer(var&& varObj);
 var makeCustom(const std::any& customObj);
@@ -249,19 +596,210 @@ var newArray(const Array& arr);
 var newArray(Array&& arr);
 var getElement(const var& arrayVar, size_t index);
 void setElement(var& arrayVar, size_t index, const var& value);
+void setElement(var& arrayVar, size_t index, var&& value);
 void appendElement(var& arrayVar, const var& value);
+void appendElement(var& arrayVar, var&& value);
 
 // Table functions
 var newTable(const Table& tbl);
 var newTable(Table&& tbl);
+var newOrderedTable(const OrderedTable& tbl);
+var newOrderedTable(OrderedTable&& tbl);
+var newRecord(const Record& rec);
+var newRecord(Record&& rec);
 var getElement(const var& tableVar, const std::string& key);
+var getElement(const var& tableVar, PropertyCache& cache);
 void setElement(var& tableVar, const std::string& key, const var& value);
+void setElement(var& tableVar, const std::string& key, var&& value);
 
 // Utility functions
 size_t len(const var& varObj);
 var range(int start, int end, int step);
 var range(int end);
 var slice(const var& arrayVar, int start, int end, int step);
+var toRecord(const var& tableVar);
+
+// Columnar conversion
+ColumnarTable toColumnar(const var& rows);
+var fromColumnar(const ColumnarTable& columns, RowKind kind);
+
+// CSV ingestion
+var readCsv(const std::string& path);
+var readCsv(const std::string& path, const CsvOptions& options);
+ColumnarTable readCsvColumnar(const std::string& path);
+ColumnarTable readCsvColumnar(const std::string& path, const CsvOptions& options);
+
+// Serialization
+Generator<std::string_view> serialize(const var& varObj, size_t chunkSize = 64 * 1024);
+
+// Deduplication
+size_t dedupe(var& tree);
+
+// Builds an Array in place with a size hint and hands it to a var without a final copy
+class ArrayBuilder {
+public:
+    explicit ArrayBuilder(size_t sizeHint = 0) { items_.reserve(sizeHint); }
+
+    ArrayBuilder& reserve(size_t count) { items_.reserve(count); return *this; }
+    ArrayBuilder& append(const var& value);
+    ArrayBuilder& append(var&& value);
+
+    // Constructs the element in place from var constructor arguments
+    template <typename... Args>
+    var& emplace(Args&&... args);
+
+    size_t size() const { return items_.size(); }
+
+    // Moves the finished Array into a var; the builder is left empty
+    var build();
+
+private:
+    Array items_;
+};
+
+// Builds a Table in place with a size hint and hands it to a var without a final copy
+class TableBuilder {
+public:
+    explicit TableBuilder(size_t sizeHint = 0) { entries_.reserve(sizeHint); }
+
+    TableBuilder& reserve(size_t count) { entries_.reserve(count); return *this; }
+    TableBuilder& set(const std::string& key, const var& value);
+    TableBuilder& set(std::string&& key, var&& value);
+
+    // Constructs (or replaces) the value for key in place from var constructor arguments
+    template <typename... Args>
+    var& emplace(std::string key, Args&&... args);
+
+    size_t size() const { return entries_.size(); }
+
+    // Moves the finished Table into a var; the builder is left empty
+    var build();
+
+private:
+    Table entries_;
+};
+
+template <typename... Args>
+var& ArrayBuilder::emplace(Args&&... args) {
+    return items_.emplace_back(std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+var& TableBuilder::emplace(std::string key, Args&&... args) {
+    auto [it, inserted] = entries_.try_emplace(std::move(key), std::forward<Args>(args)...);
+    if (!inserted) it->second = var(std::forward<Args>(args)...);
+    return it->second;
+}
+
+// Keyed container iteration; dereferencing yields a (key, value) pair of references
+template <typename Owner, typename ValueRef>
+class EntryIterator {
+public:
+    using value_type = std::pair<const std::string&, ValueRef>;
+    using reference = value_type;
+    using difference_type = std::ptrdiff_t;
+
+    EntryIterator() = default;
+    EntryIterator(Owner* owner, size_t index) : owner_(owner), index_(index) {}
+
+    reference operator*() const { return { owner_->keyAt(index_), owner_->valueAt(index_) }; }
+    EntryIterator& operator++() { ++index_; return *this; }
+    EntryIterator operator++(int) { auto copy = *this; ++index_; return copy; }
+    bool operator==(const EntryIterator& other) const { return index_ == other.index_; }
+    bool operator!=(const EntryIterator& other) const { return index_ != other.index_; }
+
+private:
+    Owner* owner_ = nullptr;
+    size_t index_ = 0;
+};
+
+inline var& OrderedTable::valueAt(size_t index) { return values_[index]; }
+inline const var& OrderedTable::valueAt(size_t index) const { return values_[index]; }
+inline OrderedTable::iterator OrderedTable::begin() { return iterator(this, 0); }
+inline OrderedTable::iterator OrderedTable::end() { return iterator(this, keys_.size()); }
+inline OrderedTable::const_iterator OrderedTable::begin() const { return const_iterator(this, 0); }
+inline OrderedTable::const_iterator OrderedTable::end() const { return const_iterator(this, keys_.size()); }
+
+inline var& Record::valueAt(size_t slot) { return slots_[slot]; }
+inline const var& Record::valueAt(size_t slot) const { return slots_[slot]; }
+inline Record::iterator Record::begin() { return iterator(this, 0); }
+inline Record::iterator Record::end() { return iterator(this, slots_.size()); }
+inline Record::const_iterator Record::begin() const { return const_iterator(this, 0); }
+inline Record::const_iterator Record::end() const { return const_iterator(this, slots_.size()); }
+
+inline bool var::isNumber() const {
+    return std::holds_alternative<int>(value) || std::holds_alternative<double>(value);
+}
+
+inline double var::toDouble() const {
+    if (const int* i = std::get_if<int>(&value)) return *i;
+    return std::get<double>(value);
+}
+
+template <typename Fn>
+bool var::forEachEntry(Fn&& fn) const {
+    auto visit = [&fn](std::string_view key, const var& value) {
+        if constexpr (std::is_same_v<std::invoke_result_t<Fn&, std::string_view, const var&>, bool>) return fn(key, value);
+        else return fn(key, value), true;
+    };
+    if (isTable()) {
+        for (const auto& [key, value] : getTable()) if (!visit(key.view(), value)) return false;
+    }
+    else if (isRecord()) {
+        for (const auto& [key, value] : getRecord()) if (!visit(key, value)) return false;
+    }
+    else if (isOrderedTable()) {
+        for (const auto& [key, value] : getOrderedTable()) if (!visit(key, value)) return false;
+    }
+    else {
+        throw std::runtime_error("var is not a Table");
+    }
+    return true;
+}
+
+// Looks up key in a table through an inline cache private to this call site and thread.
+// The cache is created once with the first key it sees, so key must be a string
+// literal; pasting it next to "" rejects anything else at compile time.
+#define HIGHCPP_GET_ELEMENT(tableVar, key) \
+    var::getElement((tableVar), []() -> PropertyCache& { static thread_local PropertyCache cache("" key); return cache; }())
+
+// Template constructors and assignment operators
+template <typename T, typename>
+var::var(T&& v) : value(std::any(std::forward<T>(v))) {}
+
+template <typename T, typename>
+var::var(T ptr) : value(ptr) {}
+
+template <typename T, typename>
+var::var(const T& wp) {
+    std::weak_ptr<void> wp_void;
+    if (auto sp = wp.lock()) {
+        wp_void = std::static_pointer_cast<void>(sp);
+    }
+    value = wp_void;
+}
+
+template <typename T, typename>
+var& var::operator=(T&& v) {
+    value = std::any(std::forward<T>(v));
+    return *this;
+}
+
+template <typename T, typename>
+var& var::operator=(T ptr) {
+    value = ptr;
+    return *this;
+}
+
+template <typename T, typename>
+var& var::operator=(const T& wp) {
+    std::weak_ptr<void> wp_void;
+    if (auto sp = wp.lock()) {
+        wp_void = std::static_pointer_cast<void>(sp);
+    }
+    value = wp_void;
+    return *this;
+}
 
 // Utility functions for smart pointers
 template <typename T>
@@ -276,7 +814,7 @@ var var::makeSmartPointer(std::shared_ptr<T>&& ptr) {
 
 template <typename T>
 var var::makeSmartPointer(std::unique_ptr<T>&& ptr) {
-    return var(std::unique_ptr<void, std::default_delete<void>>(ptr.release()));
+    return var(UniquePointer(ptr.release(), [](void* p) { delete static_cast<T*>(p); }));
 }
 
 template <typename T>
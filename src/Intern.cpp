@@ -0,0 +1,325 @@
+#include "Intern.h"
+
+#include <cstring>
+
+// ------------------------ Shallow Hashing ------------------------
+
+namespace {
+    // Heap cost of a canonical node beyond the value it takes over: the var
+    // itself plus the control block's vtable pointer and reference counts
+    constexpr long long SharedNodeOverhead = sizeof(var) + 2 * sizeof(void*);
+
+    bool isContainer(const var& node) {
+        size_t index = node.value.index();
+        return index == 4 || index == 5 || index == 12 || index == 13;
+    }
+
+    // Children a node may hold and still be interned: compared by value, or by
+    // identity for Shared nodes
+    bool isInternableChild(const var& child) {
+        size_t index = child.value.index();
+        return index <= 3 || index == 14;
+    }
+
+    size_t mix(size_t seed, size_t value) {
+        return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+
+    size_t childHash(const var& child) {
+        switch (child.value.index()) {
+        case 1: return std::hash<int>()(std::get<int>(child.value));
+        case 2: {
+            uint64_t bits;
+            double number = std::get<double>(child.value);
+            std::memcpy(&bits, &number, sizeof(bits));
+            return std::hash<uint64_t>()(bits);
+        }
+        case 3: return std::get<VarString>(child.value).hash();
+        case 14: return std::hash<const void*>()(std::get<var::Shared>(child.value).get());
+        default: return 0;
+        }
+    }
+
+    // Doubles compare bitwise so 0.0 and -0.0 stay distinct
+    bool childEqual(const var& a, const var& b) {
+        if (a.value.index() != b.value.index()) return false;
+        switch (a.value.index()) {
+        case 1: return std::get<int>(a.value) == std::get<int>(b.value);
+        case 2: return std::memcmp(&std::get<double>(a.value), &std::get<double>(b.value), sizeof(double)) == 0;
+        case 3: return std::get<VarString>(a.value) == std::get<VarString>(b.value);
+        case 14: return std::get<var::Shared>(a.value) == std::get<var::Shared>(b.value);
+        default: return true;
+        }
+    }
+
+    size_t shallowHash(const var& node) {
+        size_t seed = node.value.index();
+        switch (node.value.index()) {
+        case 4:
+            for (const var& child : std::get<Array>(node.value)) seed = mix(seed, childHash(child));
+            return seed;
+        case 5: {
+            // Entry order is unspecified, so entries are combined commutatively
+            size_t entries = 0;
+            for (const auto& [key, child] : std::get<Table>(node.value)) {
+                entries += mix(key.hash(), childHash(child));
+            }
+            return mix(seed, entries);
+        }
+        case 12:
+            for (const auto& [key, child] : std::get<OrderedTable>(node.value)) {
+                seed = mix(mix(seed, std::hash<std::string>()(key)), childHash(child));
+            }
+            return seed;
+        case 13: {
+            const Record& rec = std::get<Record>(node.value);
+            seed = mix(seed, std::hash<const void*>()(rec.shape().get()));
+            for (const var& child : rec.values()) seed = mix(seed, childHash(child));
+            return seed;
+        }
+        default:
+            return seed;
+        }
+    }
+
+    bool shallowEqual(const var& a, const var& b) {
+        if (a.value.index() != b.value.index()) return false;
+        switch (a.value.index()) {
+        case 4: {
+            const Array& x = std::get<Array>(a.value);
+            const Array& y = std::get<Array>(b.value);
+            return std::equal(x.begin(), x.end(), y.begin(), y.end(), childEqual);
+        }
+        case 5: {
+            const Table& x = std::get<Table>(a.value);
+            const Table& y = std::get<Table>(b.value);
+            if (x.size() != y.size()) return false;
+            for (const auto& [key, child] : x) {
+                auto it = y.find(key);
+                if (it == y.end() || !childEqual(child, it->second)) return false;
+            }
+            return true;
+        }
+        case 12: {
+            const OrderedTable& x = std::get<OrderedTable>(a.value);
+            const OrderedTable& y = std::get<OrderedTable>(b.value);
+            return x.keys() == y.keys() &&
+                std::equal(x.values().begin(), x.values().end(), y.values().begin(), childEqual);
+        }
+        case 13: {
+            const Record& x = std::get<Record>(a.value);
+            const Record& y = std::get<Record>(b.value);
+            return x.shape() == y.shape() &&
+                std::equal(x.values().begin(), x.values().end(), y.values().begin(), childEqual);
+        }
+        default:
+            return false;
+        }
+    }
+
+    size_t stringHeapBytes(const std::string& text) {
+        const char* data = text.data();
+        const char* self = reinterpret_cast<const char*>(&text);
+        bool isInline = data >= self && data < self + sizeof(std::string);
+        return isInline ? 0 : text.capacity() + 1;
+    }
+
+    // A heap VarString buffer holds a reference count, size and hash before its
+    // text; it is only freed with text if no other string shares it
+    size_t stringHeapBytes(const VarString& text) {
+        if (text.isInline() || text.useCount() > 1) return 0;
+        return 3 * sizeof(size_t) + text.size() + 1;
+    }
+
+    size_t childHeapBytes(const var& child) {
+        return child.value.index() == 3 ? stringHeapBytes(std::get<VarString>(child.value)) : 0;
+    }
+
+    // Estimated heap owned by an internable node; its Shared children are not counted
+    size_t heapBytes(const var& node) {
+        size_t bytes = 0;
+        switch (node.value.index()) {
+        case 4: {
+            const Array& arr = std::get<Array>(node.value);
+            bytes = arr.capacity() * sizeof(var);
+            for (const var& child : arr) bytes += childHeapBytes(child);
+            return bytes;
+        }
+        case 5: {
+            const Table& tbl = std::get<Table>(node.value);
+            bytes = tbl.bucket_count() * sizeof(void*) + tbl.size() * (sizeof(Table::value_type) + 2 * sizeof(void*));
+            for (const auto& [key, child] : tbl) bytes += stringHeapBytes(key) + childHeapBytes(child);
+            return bytes;
+        }
+        case 12: {
+            const OrderedTable& tbl = std::get<OrderedTable>(node.value);
+            bytes = tbl.keys().capacity() * sizeof(std::string) + tbl.values().capacity() * sizeof(var);
+            for (const auto& [key, child] : tbl) bytes += stringHeapBytes(key) + childHeapBytes(child);
+            return bytes;
+        }
+        case 13: {
+            const Record& rec = std::get<Record>(node.value);
+            bytes = rec.values().capacity() * sizeof(var);
+            for (const var& child : rec.values()) bytes += childHeapBytes(child);
+            return bytes;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    // Calls fn on each direct child of a container that is not itself Shared
+    template <typename Fn>
+    void forEachChild(var& node, Fn&& fn) {
+        switch (node.value.index()) {
+        case 4:
+            for (var& child : std::get<Array>(node.value)) fn(child);
+            break;
+        case 5:
+            for (auto& [key, child] : std::get<Table>(node.value)) fn(child);
+            break;
+        case 12: {
+            OrderedTable& tbl = std::get<OrderedTable>(node.value);
+            for (size_t i = 0; i < tbl.size(); ++i) fn(tbl.valueAt(i));
+        }
+        break;
+        case 13: {
+            Record& rec = std::get<Record>(node.value);
+            for (size_t i = 0; i < rec.size(); ++i) fn(rec.valueAt(i));
+        }
+        break;
+        default:
+            break;
+        }
+    }
+}
+
+// ------------------------ InternPool ------------------------
+
+var InternPool::intern(const var& value) {
+    var copy(value);
+    internInPlace(copy);
+    return copy;
+}
+
+var InternPool::intern(var&& value) {
+    internInPlace(value);
+    return std::move(value);
+}
+
+void InternPool::clear() {
+    nodes_.clear();
+    strings_.clear();
+    hits_ = 0;
+    duplicateBytes_ = 0;
+}
+
+// Post-order walk with an explicit stack, so children are canonical before their parent
+size_t InternPool::internInPlace(var& tree) {
+    struct Frame {
+        var* node;
+        bool expanded;
+    };
+
+    size_t nodesBefore = nodes_.size();
+    size_t bytesBefore = duplicateBytes_;
+    std::vector<Frame> pending{ { &tree, false } };
+    while (!pending.empty()) {
+        Frame& frame = pending.back();
+        var* node = frame.node;
+        if (!frame.expanded && isContainer(*node)) {
+            frame.expanded = true;
+            forEachChild(*node, [&](var& child) {
+                if (isContainer(child) || child.value.index() == 3) pending.push_back({ &child, false });
+            });
+            continue;
+        }
+        pending.pop_back();
+        internNode(*node);
+    }
+
+    long long saved = static_cast<long long>(duplicateBytes_ - bytesBefore) -
+        static_cast<long long>(nodes_.size() - nodesBefore) * SharedNodeOverhead;
+    return saved > 0 ? static_cast<size_t>(saved) : 0;
+}
+
+void InternPool::internNode(var& node) {
+    if (node.value.index() == 3) {
+        // Strings stay Strings: a duplicate just drops its buffer for the canonical one
+        VarString& text = std::get<VarString>(node.value);
+        if (text.size() < MinStringLength) return;
+        auto [it, inserted] = strings_.insert(text);
+        if (!inserted && it->data() != text.data()) {
+            duplicateBytes_ += stringHeapBytes(text);
+            text = *it;
+            ++hits_;
+        }
+        return;
+    }
+    if (isContainer(node)) {
+        bool internable = true;
+        forEachChild(node, [&](var& child) { internable = internable && isInternableChild(child); });
+        if (!internable) return;
+    }
+    else {
+        return;
+    }
+
+    size_t hash = shallowHash(node);
+    auto [first, last] = nodes_.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (shallowEqual(*it->second, node)) {
+            duplicateBytes_ += heapBytes(node);
+            node = var(it->second);
+            ++hits_;
+            return;
+        }
+    }
+
+    // First occurrence becomes the canonical node
+    var::Shared canonical = std::make_shared<var>(std::move(node));
+    nodes_.emplace(hash, canonical);
+    node = var(std::move(canonical));
+}
+
+// ------------------------ Deduplication ------------------------
+
+namespace {
+    // Turns Shared nodes that ended up with a single owner back into plain
+    // values. Returns how many were unwrapped.
+    size_t unwrapUnique(var& tree) {
+        size_t unwrapped = 0;
+        std::vector<var*> pending{ &tree };
+        while (!pending.empty()) {
+            var* node = pending.back();
+            pending.pop_back();
+            if (node->isShared()) {
+                // Subtrees of a node that is still shared stay immutable
+                if (node->getShared().use_count() != 1) continue;
+                node->unshare();
+                ++unwrapped;
+            }
+            forEachChild(*node, [&](var& child) { pending.push_back(&child); });
+        }
+        return unwrapped;
+    }
+}
+
+size_t var::dedupe(var& tree) {
+    size_t duplicateBytes, canonicalNodes;
+    {
+        InternPool pool;
+        pool.internInPlace(tree);
+        duplicateBytes = pool.duplicateBytes();
+        // Canonical strings are plain buffers, not Shared nodes, so they cost no overhead
+        canonicalNodes = pool.nodeCount();
+    }
+    // Once the pool lets go, values seen only once need not stay behind a Shared node
+    size_t sharedNodes = canonicalNodes - unwrapUnique(tree);
+    long long saved = static_cast<long long>(duplicateBytes) - static_cast<long long>(sharedNodes) * SharedNodeOverhead;
+    return saved > 0 ? static_cast<size_t>(saved) : 0;
+}
+
+size_t dedupe(var& tree) {
+    return var::dedupe(tree);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "HighCPP.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+// Hash-consing pool. Interning a var replaces every container whose children are
+// all scalars, strings or interned nodes with the pool's canonical var::Shared
+// node for that value, and points every long String at the pool's buffer for
+// its text. Equal subtrees then share one immutable copy, and copying them only
+// bumps a reference count.
+//
+//   InternPool pool;
+//   for (...) rows.append(pool.intern(parseRow(line)));
+//
+// Children are interned before their parents, so equality of a node is a
+// shallow comparison against canonical child pointers. The pool keeps every
+// canonical node alive until clear() or destruction. Not thread-safe; the
+// Shared nodes it hands out may be read from any thread.
+class InternPool {
+public:
+    // Shorter strings are stored inline in their VarString and never shared
+    static constexpr size_t MinStringLength = VarString::InlineCapacity + 1;
+
+    var intern(const var& value);
+    var intern(var&& value);
+
+    // Interns tree in place; returns the estimated heap bytes saved by this call
+    size_t internInPlace(var& tree);
+
+    // Number of canonical nodes and strings, of values replaced by an existing
+    // canonical one, and the estimated heap bytes those replaced values held
+    size_t size() const { return nodes_.size() + strings_.size(); }
+    size_t nodeCount() const { return nodes_.size(); } // Canonical Shared nodes only
+    size_t hits() const { return hits_; }
+    size_t duplicateBytes() const { return duplicateBytes_; }
+
+    void clear();
+
+private:
+    void internNode(var& node);
+
+    std::unordered_multimap<size_t, var::Shared> nodes_;  // Keyed by shallow hash
+    std::unordered_set<VarString, VarStringHash, VarStringEqual> strings_;
+    size_t hits_ = 0;
+    size_t duplicateBytes_ = 0;
+};
@@ -0,0 +1,146 @@
+#include "Operators.h"
+
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace varops {
+    const char* operatorName(BinaryOp op) {
+        switch (op) {
+        case BinaryOp::Add: return "+";
+        case BinaryOp::Sub: return "-";
+        case BinaryOp::Mul: return "*";
+        case BinaryOp::Div: return "/";
+        case BinaryOp::Mod: return "%";
+        case BinaryOp::Eq: return "==";
+        case BinaryOp::Ne: return "!=";
+        case BinaryOp::Lt: return "<";
+        case BinaryOp::Le: return "<=";
+        case BinaryOp::Gt: return ">";
+        default: return ">=";
+        }
+    }
+
+    namespace {
+        // Elementwise over nested Arrays; dispatches the runtime op to the fused evaluator
+        var broadcast(BinaryOp op, const var& a, const var& b) {
+            auto run = [&](auto tag) {
+                return materialize(BinaryVarExpr<decltype(tag)::value, VarRef, VarRef>(VarRef(a), VarRef(b)));
+            };
+            switch (op) {
+            case BinaryOp::Add: return run(std::integral_constant<BinaryOp, BinaryOp::Add>());
+            case BinaryOp::Sub: return run(std::integral_constant<BinaryOp, BinaryOp::Sub>());
+            case BinaryOp::Mul: return run(std::integral_constant<BinaryOp, BinaryOp::Mul>());
+            case BinaryOp::Div: return run(std::integral_constant<BinaryOp, BinaryOp::Div>());
+            case BinaryOp::Mod: return run(std::integral_constant<BinaryOp, BinaryOp::Mod>());
+            case BinaryOp::Eq: return run(std::integral_constant<BinaryOp, BinaryOp::Eq>());
+            case BinaryOp::Ne: return run(std::integral_constant<BinaryOp, BinaryOp::Ne>());
+            case BinaryOp::Lt: return run(std::integral_constant<BinaryOp, BinaryOp::Lt>());
+            case BinaryOp::Le: return run(std::integral_constant<BinaryOp, BinaryOp::Le>());
+            case BinaryOp::Gt: return run(std::integral_constant<BinaryOp, BinaryOp::Gt>());
+            default: return run(std::integral_constant<BinaryOp, BinaryOp::Ge>());
+            }
+        }
+    }
+
+    bool equals(const var& x, const var& y) {
+        std::vector<std::pair<const var*, const var*>> pending{ { &x, &y } };
+        while (!pending.empty()) {
+            auto [a, b] = pending.back();
+            pending.pop_back();
+            if (a->isNumber() || b->isNumber()) {
+                if (!a->isNumber() || !b->isNumber()) return false;
+                bool equal = a->isInt() && b->isInt() ? std::get<int>(a->value) == std::get<int>(b->value) : a->toDouble() == b->toDouble();
+                if (!equal) return false;
+                continue;
+            }
+
+            if (a->isKeyed() && b->isKeyed()) {
+                if (var::len(*a) != var::len(*b)) return false;
+                bool sameKeys = a->forEachEntry([&](std::string_view key, const var& value) {
+                    const var* other = b->find(key);
+                    if (!other) return false;
+                    pending.emplace_back(&value, other);
+                    return true;
+                });
+                if (!sameKeys) return false;
+                continue;
+            }
+            varType typeA = getVarType(*a);
+            varType typeB = getVarType(*b);
+            if (typeA != typeB) {
+                if (typeA == varType::Null || typeB == varType::Null) return false;
+                if (typeA < varType::Pointer && typeB < varType::Pointer) return false;
+                throw std::runtime_error("Cannot compare " + a->typeOf() + " and " + b->typeOf());
+            }
+
+            switch (typeA) {
+            case varType::Null:
+                break;
+            case varType::String:
+                if (a->getString() != b->getString()) return false;
+                break;
+            case varType::Array: {
+                const Array& arrA = a->getArray();
+                const Array& arrB = b->getArray();
+                if (arrA.size() != arrB.size()) return false;
+                for (size_t i = 0; i < arrA.size(); ++i) pending.emplace_back(&arrA[i], &arrB[i]);
+                break;
+            }
+            default:
+                throw std::runtime_error("Cannot compare " + a->typeOf() + " and " + b->typeOf());
+            }
+        }
+        return true;
+    }
+
+    bool compare(BinaryOp op, const var& x, const var& y) {
+        if (op == BinaryOp::Eq) return equals(x, y);
+        if (op == BinaryOp::Ne) return !equals(x, y);
+        if (x.isInt() && y.isInt()) return compareValues(op, std::get<int>(x.value), std::get<int>(y.value));
+        if (x.isNumber() && y.isNumber()) return compareValues(op, x.toDouble(), y.toDouble());
+        if (x.isString() && y.isString()) return compareValues(op, x.getString().view(), y.getString().view());
+        throw std::runtime_error("Cannot compare " + x.typeOf() + " and " + y.typeOf());
+    }
+
+    var scalarArithmetic(BinaryOp op, const var& x, const var& y) {
+        if (op == BinaryOp::Add && x.isString() && y.isString()) return var(VarString::concat(x.getString(), y.getString()));
+        throw std::runtime_error(std::string("Unsupported operand types for ") + operatorName(op) + ": " + x.typeOf() + " and " + y.typeOf());
+    }
+
+    Element slowApply(BinaryOp op, const Element& a, const Element& b) {
+        // At least one side is a Value; box the other so both can use the var API
+        var boxedA = a.kind == Element::Kind::Value ? var() : toVar(Element(a));
+        var boxedB = b.kind == Element::Kind::Value ? var() : toVar(Element(b));
+        const var& x = a.kind == Element::Kind::Value ? a.value() : boxedA;
+        const var& y = b.kind == Element::Kind::Value ? b.value() : boxedB;
+
+        if (x.isArray() || y.isArray()) return Element::computed(broadcast(op, x, y));
+        if (isComparison(op)) return Element::boolean(compare(op, x, y));
+        return Element::computed(scalarArithmetic(op, x, y));
+    }
+
+    Element slowNegate(const Element& a) {
+        const var& x = a.value();
+        if (x.isArray()) return Element::computed(materialize(NegateVarExpr<VarRef>(VarRef(x))));
+        throw std::runtime_error("Unsupported operand type for -: " + x.typeOf());
+    }
+
+    var toVar(Element&& e) {
+        switch (e.kind) {
+        case Element::Kind::Int: return var(e.i);
+        case Element::Kind::Double: return var(e.d);
+        default:
+            if (e.owned) return std::move(*e.owned);
+            return *e.ref;
+        }
+    }
+
+    void divisionByZero() {
+        throw std::domain_error("Division by zero");
+    }
+
+    void lengthMismatch(size_t a, size_t b) {
+        throw std::invalid_argument("Array lengths do not match: " + std::to_string(a) + " and " + std::to_string(b));
+    }
+}
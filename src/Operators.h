@@ -0,0 +1,389 @@
+#pragma once
+
+#include "HighCPP.h"
+
+#include <cmath>
+#include <limits>
+#include <optional>
+
+// Arithmetic and comparison operators for var.
+//
+//   var total = prices * quantities + 1.5;    // Arrays are combined elementwise
+//   var cheap = prices < 10;                  // Array of 1/0
+//
+// Numbers follow the same rules as Expression, which shares the helpers below:
+// int op int stays Int (int / int is integer division, overflow becomes Double),
+// anything with a Double is Double, and int division or modulo by zero throws
+// std::domain_error. Comparisons yield Int 1 or 0 and also order Strings.
+// == is structural (see varops::equals) and + concatenates Strings.
+// Arrays broadcast, so == on two Arrays compares them element by element;
+// call varops::equals to compare whole Arrays.
+//
+// An Array combined with a scalar applies the scalar to every element; two
+// Arrays must have the same length (std::invalid_argument otherwise). Nested
+// Arrays broadcast recursively.
+//
+// Operators build lazy expressions instead of vars. A chain like a * b + c is
+// evaluated in one pass when it is converted to a var, writing a single result
+// Array with no temporary Array per operator. Expressions borrow var lvalues, so
+// convert them to var within the statement that creates them.
+
+enum class BinaryOp {
+    Add, Sub, Mul, Div, Mod,
+    Eq, Ne, Lt, Le, Gt, Ge
+};
+
+namespace varops {
+    // ---- Rules shared with Expression ----
+
+    [[noreturn]] void divisionByZero();
+
+    const char* operatorName(BinaryOp op);
+
+    constexpr bool isComparison(BinaryOp op) {
+        return op >= BinaryOp::Eq;
+    }
+
+    // Int results outside int's range become Double
+    inline bool fitsInt(long long value) {
+        return value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max();
+    }
+
+    // Arithmetic ops only; operands are widened so the result can be range checked
+    inline long long intArithmetic(BinaryOp op, long long x, long long y) {
+        switch (op) {
+        case BinaryOp::Add: return x + y;
+        case BinaryOp::Sub: return x - y;
+        case BinaryOp::Mul: return x * y;
+        case BinaryOp::Div:
+            if (y == 0) divisionByZero();
+            return x / y;
+        default:
+            if (y == 0) divisionByZero();
+            return x % y;
+        }
+    }
+
+    inline double doubleArithmetic(BinaryOp op, double x, double y) {
+        switch (op) {
+        case BinaryOp::Add: return x + y;
+        case BinaryOp::Sub: return x - y;
+        case BinaryOp::Mul: return x * y;
+        case BinaryOp::Div: return x / y;
+        default: return std::fmod(x, y);
+        }
+    }
+
+    // Comparison ops only, on two values of one type (numbers, string views)
+    template <typename T>
+    bool compareValues(BinaryOp op, const T& x, const T& y) {
+        switch (op) {
+        case BinaryOp::Eq: return x == y;
+        case BinaryOp::Ne: return x != y;
+        case BinaryOp::Lt: return x < y;
+        case BinaryOp::Le: return x <= y;
+        case BinaryOp::Gt: return x > y;
+        default: return x >= y;
+        }
+    }
+
+    // Structural equality: Null equals Null, numbers compare by value whatever
+    // their type, Strings by content, Arrays element by element, and Tables of
+    // any kind by their key sets and values (entry order is ignored). Values of
+    // different types are unequal. Pointers and Objects have no value to compare
+    // and throw std::runtime_error. Iterative, so deep trees are fine.
+    bool equals(const var& x, const var& y);
+
+    // Any comparison op on two vars: == and != use equals, ordering is defined
+    // for numbers and Strings and throws std::runtime_error for anything else
+    bool compare(BinaryOp op, const var& x, const var& y);
+
+    // Arithmetic on operands that are not both numbers: String + String
+    // concatenates, anything else throws std::runtime_error
+    var scalarArithmetic(BinaryOp op, const var& x, const var& y);
+
+    // ---- Expression templates ----
+
+    // Marks a length with no Array involved; the expression is a single scalar
+    constexpr size_t ScalarLength = std::numeric_limits<size_t>::max();
+
+    // One element of an expression: a number kept unboxed, or any other var,
+    // either borrowed from an operand or computed and held here
+    struct Element {
+        enum class Kind : uint8_t { Int, Double, Value };
+
+        Kind kind = Kind::Int;
+        int i = 0;
+        double d = 0.0;
+        const var* ref = nullptr;   // Kind::Value borrowed from an operand
+        std::optional<var> owned;   // Kind::Value computed by the expression
+
+        const var& value() const { return owned ? *owned : *ref; }
+
+        static Element integer(long long value) {
+            Element e;
+            if (!fitsInt(value)) {
+                e.kind = Kind::Double;
+                e.d = static_cast<double>(value);
+            }
+            else {
+                e.i = static_cast<int>(value);
+            }
+            return e;
+        }
+
+        static Element real(double value) {
+            Element e;
+            e.kind = Kind::Double;
+            e.d = value;
+            return e;
+        }
+
+        static Element boolean(bool value) {
+            Element e;
+            e.i = value ? 1 : 0;
+            return e;
+        }
+
+        static Element of(const var& value) {
+            if (const int* number = std::get_if<int>(&value.value)) return integer(*number);
+            if (const double* number = std::get_if<double>(&value.value)) return real(*number);
+            Element e;
+            e.kind = Kind::Value;
+            e.ref = &value;
+            return e;
+        }
+
+        static Element computed(var&& value) {
+            Element e;
+            e.kind = Kind::Value;
+            e.owned.emplace(std::move(value));
+            return e;
+        }
+
+        double number() const { return kind == Kind::Int ? i : d; }
+    };
+
+    // Out of line: everything that is not plain int/double arithmetic
+    Element slowApply(BinaryOp op, const Element& a, const Element& b);
+    Element slowNegate(const Element& a);
+    var toVar(Element&& e);
+    [[noreturn]] void lengthMismatch(size_t a, size_t b);
+
+    inline size_t broadcastLength(size_t a, size_t b) {
+        if (a == ScalarLength) return b;
+        if (b == ScalarLength || a == b) return a;
+        lengthMismatch(a, b);
+    }
+
+    // The Array a var stands for (seeing through Shared nodes), or null
+    inline const Array* arrayOf(const var& value) {
+        if (const var::Shared* shared = std::get_if<var::Shared>(&value.value)) return std::get_if<Array>(&(*shared)->value);
+        return std::get_if<Array>(&value.value);
+    }
+
+    template <BinaryOp Op>
+    Element apply(const Element& a, const Element& b) {
+        using Kind = Element::Kind;
+        // Op is a constant, so the shared helpers' switches fold away
+        if (a.kind == Kind::Int && b.kind == Kind::Int) {
+            if constexpr (isComparison(Op)) return Element::boolean(compareValues(Op, a.i, b.i));
+            else return Element::integer(intArithmetic(Op, a.i, b.i));
+        }
+        if (a.kind != Kind::Value && b.kind != Kind::Value) {
+            if constexpr (isComparison(Op)) return Element::boolean(compareValues(Op, a.number(), b.number()));
+            else return Element::real(doubleArithmetic(Op, a.number(), b.number()));
+        }
+        return slowApply(Op, a, b);
+    }
+
+    // ---- Leaves ----
+
+    // Borrows a var operand
+    class VarRef {
+    public:
+        explicit VarRef(const var& value) : value_(&value), array_(arrayOf(value)) {}
+
+        size_t length() const { return array_ ? array_->size() : ScalarLength; }
+        Element at(size_t i) const { return Element::of(array_ ? (*array_)[i] : *value_); }
+
+    private:
+        const var* value_;
+        const Array* array_;
+    };
+
+    // Owns a temporary var operand
+    class VarValue {
+    public:
+        explicit VarValue(var&& value) : value_(std::move(value)) {}
+
+        size_t length() const {
+            const Array* array = arrayOf(value_);
+            return array ? array->size() : ScalarLength;
+        }
+        Element at(size_t i) const {
+            const Array* array = arrayOf(value_);
+            return Element::of(array ? (*array)[i] : value_);
+        }
+
+    private:
+        var value_;
+    };
+
+    // A C++ number operand
+    class Constant {
+    public:
+        template <typename T>
+        explicit Constant(T value) {
+            if constexpr (std::is_integral_v<T>) {
+                if constexpr (std::is_signed_v<T>) element_ = Element::integer(static_cast<long long>(value));
+                else if (value <= static_cast<unsigned long long>(std::numeric_limits<int>::max())) element_ = Element::integer(static_cast<long long>(value));
+                else element_ = Element::real(static_cast<double>(value));
+            }
+            else {
+                element_ = Element::real(static_cast<double>(value));
+            }
+        }
+
+        size_t length() const { return ScalarLength; }
+        Element at(size_t) const { return element_; }
+
+    private:
+        Element element_;
+    };
+
+    // Evaluates an expression in one pass: a scalar, or an Array built element by element
+    template <typename Expr>
+    var materialize(const Expr& expr) {
+        size_t length = expr.length();
+        if (length == ScalarLength) return toVar(expr.at(0));
+        Array result;
+        result.reserve(length);
+        for (size_t i = 0; i < length; ++i) result.emplace_back(toVar(expr.at(i)));
+        return var(std::move(result));
+    }
+}
+
+// ------------------------ Expression Nodes ------------------------
+
+template <BinaryOp Op, typename L, typename R>
+class BinaryVarExpr {
+public:
+    BinaryVarExpr(L lhs, R rhs) : lhs_(std::move(lhs)), rhs_(std::move(rhs)) {}
+
+    size_t length() const { return varops::broadcastLength(lhs_.length(), rhs_.length()); }
+    varops::Element at(size_t i) const { return varops::apply<Op>(lhs_.at(i), rhs_.at(i)); }
+
+    var evaluate() const { return varops::materialize(*this); }
+    operator var() const { return evaluate(); }
+
+private:
+    L lhs_;
+    R rhs_;
+};
+
+template <typename E>
+class NegateVarExpr {
+public:
+    explicit NegateVarExpr(E operand) : operand_(std::move(operand)) {}
+
+    size_t length() const { return operand_.length(); }
+    varops::Element at(size_t i) const {
+        varops::Element e = operand_.at(i);
+        if (e.kind == varops::Element::Kind::Int) return varops::Element::integer(-static_cast<long long>(e.i));
+        if (e.kind == varops::Element::Kind::Double) return varops::Element::real(-e.d);
+        return varops::slowNegate(e);
+    }
+
+    var evaluate() const { return varops::materialize(*this); }
+    operator var() const { return evaluate(); }
+
+private:
+    E operand_;
+};
+
+template <BinaryOp Op, typename L, typename R>
+struct is_var_expr<BinaryVarExpr<Op, L, R>> : std::true_type {};
+
+template <typename E>
+struct is_var_expr<NegateVarExpr<E>> : std::true_type {};
+
+// ------------------------ Operators ------------------------
+
+namespace varops {
+    template <typename T>
+    struct is_operand : std::bool_constant<
+        std::is_same_v<std::decay_t<T>, var> ||
+        is_var_expr<std::decay_t<T>>::value ||
+        (std::is_arithmetic_v<std::decay_t<T>> && !std::is_same_v<std::decay_t<T>, bool>)> {};
+
+    // At least one side must be a var or an expression
+    template <typename L, typename R>
+    using enable_binary = std::enable_if_t<
+        is_operand<L>::value && is_operand<R>::value &&
+        !(std::is_arithmetic_v<std::decay_t<L>> && std::is_arithmetic_v<std::decay_t<R>>)>;
+
+    inline VarRef operand(const var& value) { return VarRef(value); }
+    inline VarValue operand(var&& value) { return VarValue(std::move(value)); }
+
+    template <typename T, typename = std::enable_if_t<!std::is_same_v<std::decay_t<T>, var>>>
+    auto operand(T&& value) {
+        if constexpr (std::is_arithmetic_v<std::decay_t<T>>) return Constant(value);
+        else return std::decay_t<T>(std::forward<T>(value));
+    }
+
+    template <typename T>
+    using operand_t = decltype(operand(std::declval<T>()));
+
+    template <BinaryOp Op, typename L, typename R>
+    auto combine(L&& lhs, R&& rhs) {
+        return BinaryVarExpr<Op, operand_t<L>, operand_t<R>>(operand(std::forward<L>(lhs)), operand(std::forward<R>(rhs)));
+    }
+}
+
+#define HIGHCPP_VAR_OPERATOR(symbol, op) \
+    template <typename L, typename R, typename = varops::enable_binary<L, R>> \
+    auto operator symbol(L&& lhs, R&& rhs) { \
+        return varops::combine<op>(std::forward<L>(lhs), std::forward<R>(rhs)); \
+    }
+
+HIGHCPP_VAR_OPERATOR(+, BinaryOp::Add)
+HIGHCPP_VAR_OPERATOR(-, BinaryOp::Sub)
+HIGHCPP_VAR_OPERATOR(*, BinaryOp::Mul)
+HIGHCPP_VAR_OPERATOR(/, BinaryOp::Div)
+HIGHCPP_VAR_OPERATOR(%, BinaryOp::Mod)
+HIGHCPP_VAR_OPERATOR(==, BinaryOp::Eq)
+HIGHCPP_VAR_OPERATOR(!=, BinaryOp::Ne)
+HIGHCPP_VAR_OPERATOR(<, BinaryOp::Lt)
+HIGHCPP_VAR_OPERATOR(<=, BinaryOp::Le)
+HIGHCPP_VAR_OPERATOR(>, BinaryOp::Gt)
+HIGHCPP_VAR_OPERATOR(>=, BinaryOp::Ge)
+
+#undef HIGHCPP_VAR_OPERATOR
+
+template <typename T, typename = std::enable_if_t<std::is_same_v<std::decay_t<T>, var> || is_var_expr<std::decay_t<T>>::value>>
+auto operator-(T&& operand) {
+    using Operand = varops::operand_t<T>;
+    return NegateVarExpr<Operand>(varops::operand(std::forward<T>(operand)));
+}
+
+// Compound assignment evaluates the whole right-hand side before replacing lhs
+template <typename R, typename = varops::enable_binary<var, R>>
+var& operator+=(var& lhs, R&& rhs) { return lhs = (lhs + std::forward<R>(rhs)).evaluate(); }
+
+template <typename R, typename = varops::enable_binary<var, R>>
+var& operator-=(var& lhs, R&& rhs) { return lhs = (lhs - std::forward<R>(rhs)).evaluate(); }
+
+template <typename R, typename = varops::enable_binary<var, R>>
+var& operator*=(var& lhs, R&& rhs) { return lhs = (lhs * std::forward<R>(rhs)).evaluate(); }
+
+template <typename R, typename = varops::enable_binary<var, R>>
+var& operator/=(var& lhs, R&& rhs) { return lhs = (lhs / std::forward<R>(rhs)).evaluate(); }
+
+template <typename R, typename = varops::enable_binary<var, R>>
+var& operator%=(var& lhs, R&& rhs) { return lhs = (lhs % std::forward<R>(rhs)).evaluate(); }
+
+template <typename E, typename = std::enable_if_t<is_var_expr<E>::value>>
+std::ostream& operator<<(std::ostream& os, const E& expr) {
+    return os << expr.evaluate();
+}
@@ -0,0 +1,344 @@
+#include "Schema.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+// ------------------------ Program ------------------------
+
+namespace {
+    constexpr uint32_t NoNode = std::numeric_limits<uint32_t>::max();
+
+    // Type mask bits, one per varType
+    constexpr uint32_t typeBit(varType type) {
+        return 1u << static_cast<uint32_t>(type);
+    }
+
+    constexpr uint32_t AnyType = ~0u;
+    constexpr uint32_t NumberTypes = typeBit(varType::Int) | typeBit(varType::Double);
+    constexpr uint32_t KeyedTypes = typeBit(varType::Table) | typeBit(varType::OrderedTable) | typeBit(varType::Record);
+
+    enum NodeFlags : uint32_t {
+        HasMin = 1 << 0,
+        HasMax = 1 << 1,
+        HasMinLength = 1 << 2,
+        HasMaxLength = 1 << 3,
+        HasMinItems = 1 << 4,
+        HasMaxItems = 1 << 5,
+        Closed = 1 << 6     // additionalProperties: 0
+    };
+
+    struct SchemaNode {
+        uint32_t typeMask = AnyType;
+        uint32_t flags = 0;
+        double min = 0.0;
+        double max = 0.0;
+        size_t minLength = 0;
+        size_t maxLength = 0;
+        size_t minItems = 0;
+        size_t maxItems = 0;
+        uint32_t items = NoNode;
+        uint32_t firstProperty = 0;  // Properties of a node are contiguous and sorted by key
+        uint32_t propertyCount = 0;
+    };
+
+    struct SchemaProperty {
+        std::string key;
+        uint32_t node;
+        bool required;
+    };
+}
+
+struct SchemaProgram {
+    std::vector<SchemaNode> nodes;  // Node 0 is the root
+    std::vector<SchemaProperty> properties;
+};
+
+// ------------------------ Compiler ------------------------
+
+namespace {
+    const char* typeName(varType type) {
+        switch (type) {
+        case varType::Null: return "Null";
+        case varType::Int: return "Int";
+        case varType::Double: return "Double";
+        case varType::String: return "String";
+        case varType::Array: return "Array";
+        case varType::Table: return "Table";
+        case varType::OrderedTable: return "OrderedTable";
+        case varType::Record: return "Record";
+        case varType::Pointer: return "Pointer";
+        case varType::RawPointer: return "RawPointer";
+        case varType::SharedPointer: return "SharedPointer";
+        case varType::UniquePointer: return "UniquePointer";
+        case varType::WeakPointer: return "WeakPointer";
+        default: return "Object";
+        }
+    }
+
+    uint32_t parseTypeName(std::string_view name) {
+        if (name == "Any") return AnyType;
+        if (name == "Number") return NumberTypes;
+        if (name == "Table") return KeyedTypes;
+        static const varType types[] = {
+            varType::Null, varType::Int, varType::Double, varType::String, varType::Array,
+            varType::OrderedTable, varType::Record
+        };
+        for (varType type : types) {
+            if (name == typeName(type)) return typeBit(type);
+        }
+        return 0;
+    }
+
+    class SchemaCompiler {
+    public:
+        std::shared_ptr<const SchemaProgram> compile(const var& description) {
+            compileNode(description, "$");
+            return program_;
+        }
+
+    private:
+        [[noreturn]] static void fail(const std::string& path, const std::string& message) {
+            throw std::invalid_argument("Schema error at " + path + ": " + message);
+        }
+
+        static double number(const var& value, const std::string& path, const char* key) {
+            if (value.isNumber()) return value.toDouble();
+            fail(path, std::string("'") + key + "' is not a number");
+        }
+
+        static size_t count(const var& value, const std::string& path, const char* key) {
+            if (!value.isInt() || std::get<int>(value.value) < 0) fail(path, std::string("'") + key + "' is not a non-negative Int");
+            return static_cast<size_t>(std::get<int>(value.value));
+        }
+
+        // Recursion follows the schema, not the document, so its depth is bounded by the schema
+        uint32_t compileNode(const var& description, const std::string& path) {
+            if (!description.isKeyed()) fail(path, "schema is not a Table");
+
+            uint32_t index = static_cast<uint32_t>(program_->nodes.size());
+            program_->nodes.emplace_back();
+            SchemaNode node;
+
+            if (const var* type = description.find("type")) node.typeMask = parseTypes(*type, path);
+            if (const var* v = description.find("min")) { node.min = number(*v, path, "min"); node.flags |= HasMin; }
+            if (const var* v = description.find("max")) { node.max = number(*v, path, "max"); node.flags |= HasMax; }
+            if (const var* v = description.find("minLength")) { node.minLength = count(*v, path, "minLength"); node.flags |= HasMinLength; }
+            if (const var* v = description.find("maxLength")) { node.maxLength = count(*v, path, "maxLength"); node.flags |= HasMaxLength; }
+            if (const var* v = description.find("minItems")) { node.minItems = count(*v, path, "minItems"); node.flags |= HasMinItems; }
+            if (const var* v = description.find("maxItems")) { node.maxItems = count(*v, path, "maxItems"); node.flags |= HasMaxItems; }
+            if (const var* v = description.find("additionalProperties")) {
+                if (!v->isInt()) fail(path, "'additionalProperties' is not an Int");
+                if (std::get<int>(v->value) == 0) node.flags |= Closed;
+            }
+
+            if (const var* items = description.find("items")) node.items = compileNode(*items, path + "[]");
+
+            // Gather properties first: child nodes are appended while compiling them
+            std::vector<std::pair<std::string, const var*>> declared;
+            if (const var* properties = description.find("properties")) {
+                if (!properties->isKeyed()) fail(path, "'properties' is not a Table");
+                properties->forEachEntry([&](std::string_view key, const var& schema) { declared.emplace_back(key, &schema); });
+            }
+            std::vector<std::string> required;
+            if (const var* list = description.find("required")) {
+                if (!list->isArray()) fail(path, "'required' is not an Array");
+                for (const var& key : list->getArray()) {
+                    if (!key.isString()) fail(path, "'required' entry is not a String");
+                    required.push_back(key.getString().str());
+                }
+            }
+            for (const std::string& key : required) {
+                auto match = [&](const auto& entry) { return entry.first == key; };
+                if (std::find_if(declared.begin(), declared.end(), match) == declared.end()) declared.emplace_back(key, nullptr);
+            }
+            std::sort(declared.begin(), declared.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+            std::vector<SchemaProperty> properties;
+            properties.reserve(declared.size());
+            for (const auto& [key, schema] : declared) {
+                uint32_t child = NoNode;
+                if (schema) child = compileNode(*schema, path + "." + key);
+                bool isRequired = std::find(required.begin(), required.end(), key) != required.end();
+                properties.push_back({ key, child, isRequired });
+            }
+
+            node.firstProperty = static_cast<uint32_t>(program_->properties.size());
+            node.propertyCount = static_cast<uint32_t>(properties.size());
+            for (SchemaProperty& property : properties) program_->properties.push_back(std::move(property));
+
+            program_->nodes[index] = node;
+            return index;
+        }
+
+        static uint32_t parseTypes(const var& type, const std::string& path) {
+            auto parseOne = [&](const var& name) {
+                if (!name.isString()) fail(path, "'type' is not a String");
+                uint32_t mask = parseTypeName(name.getString());
+                if (mask == 0) fail(path, "unknown type '" + name.getString().str() + "'");
+                return mask;
+            };
+            if (!type.isArray()) return parseOne(type);
+            uint32_t mask = 0;
+            for (const var& name : type.getArray()) mask |= parseOne(name);
+            return mask;
+        }
+
+        std::shared_ptr<SchemaProgram> program_ = std::make_shared<SchemaProgram>();
+    };
+}
+
+Schema Schema::compile(const var& description) {
+    return Schema(SchemaCompiler().compile(description));
+}
+
+size_t Schema::nodeCount() const {
+    return program_->nodes.size();
+}
+
+// ------------------------ Validation ------------------------
+
+namespace {
+    // One step of the path from the root: a key or an Array index
+    struct PathSegment {
+        const std::string* key;
+        size_t index;
+    };
+
+    class SchemaValidation {
+    public:
+        SchemaValidation(const SchemaProgram& program, std::vector<SchemaViolation>* violations)
+            : program_(program), violations_(violations) {}
+
+        bool failed() const { return failed_; }
+
+        void check(uint32_t nodeIndex, const var& value) {
+            const SchemaNode& node = program_.nodes[nodeIndex];
+            varType type = getVarType(value);
+            if (!(node.typeMask & typeBit(type))) {
+                report([&] { return "expected " + describeTypes(node.typeMask) + ", got " + value.typeOf(); });
+                return;
+            }
+
+            switch (type) {
+            case varType::Int:
+            case varType::Double: {
+                if (!(node.flags & (HasMin | HasMax))) break;
+                double number = value.toDouble();
+                if ((node.flags & HasMin) && number < node.min) report([&] { return "value " + toText(number) + " is below minimum " + toText(node.min); });
+                if ((node.flags & HasMax) && number > node.max) report([&] { return "value " + toText(number) + " is above maximum " + toText(node.max); });
+                break;
+            }
+            case varType::String: {
+                size_t length = value.getString().size();
+                if ((node.flags & HasMinLength) && length < node.minLength) report([&] { return "length " + std::to_string(length) + " is below minLength " + std::to_string(node.minLength); });
+                if ((node.flags & HasMaxLength) && length > node.maxLength) report([&] { return "length " + std::to_string(length) + " is above maxLength " + std::to_string(node.maxLength); });
+                break;
+            }
+            case varType::Array: {
+                const Array& items = value.getArray();
+                if ((node.flags & HasMinItems) && items.size() < node.minItems) report([&] { return std::to_string(items.size()) + " items is below minItems " + std::to_string(node.minItems); });
+                if ((node.flags & HasMaxItems) && items.size() > node.maxItems) report([&] { return std::to_string(items.size()) + " items is above maxItems " + std::to_string(node.maxItems); });
+                if (node.items == NoNode) break;
+                for (size_t i = 0; i < items.size() && !stopped(); ++i) {
+                    path_.push_back({ nullptr, i });
+                    check(node.items, items[i]);
+                    path_.pop_back();
+                }
+                break;
+            }
+            case varType::Table:
+            case varType::OrderedTable:
+            case varType::Record:
+                checkProperties(node, value);
+                break;
+            default:
+                break;
+            }
+        }
+
+    private:
+        bool stopped() const { return failed_ && !violations_; }
+
+        void checkProperties(const SchemaNode& node, const var& object) {
+            size_t matched = 0;
+            for (uint32_t i = 0; i < node.propertyCount && !stopped(); ++i) {
+                const SchemaProperty& property = program_.properties[node.firstProperty + i];
+                const var* value = object.find(property.key);
+                if (!value) {
+                    if (property.required) report([&] { return "missing required key '" + property.key + "'"; });
+                    continue;
+                }
+                ++matched;
+                if (property.node == NoNode) continue;
+                path_.push_back({ &property.key, 0 });
+                check(property.node, *value);
+                path_.pop_back();
+            }
+
+            // Unknown keys are only searched for once the counts disagree
+            if (!(node.flags & Closed) || stopped() || matched == var::len(object)) return;
+            auto first = program_.properties.begin() + node.firstProperty;
+            auto last = first + node.propertyCount;
+            object.forEachEntry([&](std::string_view key, const var&) {
+                auto it = std::lower_bound(first, last, key, [](const SchemaProperty& p, std::string_view k) { return p.key < k; });
+                if (it == last || it->key != key) report([&] { return "unexpected key '" + std::string(key) + "'"; });
+            });
+        }
+
+        template <typename Message>
+        void report(Message&& message) {
+            failed_ = true;
+            if (violations_) violations_->push_back({ pathText(), message() });
+        }
+
+        std::string pathText() const {
+            std::string text = "$";
+            for (const PathSegment& segment : path_) {
+                if (segment.key) text += "." + *segment.key;
+                else text += "[" + std::to_string(segment.index) + "]";
+            }
+            return text;
+        }
+
+        static std::string toText(double number) {
+            std::ostringstream os;
+            os << number;
+            return os.str();
+        }
+
+        static std::string describeTypes(uint32_t mask) {
+            std::string text;
+            auto add = [&](const char* name) {
+                if (!text.empty()) text += " or ";
+                text += name;
+            };
+            if ((mask & KeyedTypes) == KeyedTypes) {
+                add("Table");
+                mask &= ~KeyedTypes;
+            }
+            for (uint32_t bit = 0; bit < 32; ++bit) {
+                if (mask & (1u << bit)) add(typeName(static_cast<varType>(bit)));
+            }
+            return text;
+        }
+
+        const SchemaProgram& program_;
+        std::vector<SchemaViolation>* violations_;  // Null when only validity is wanted
+        std::vector<PathSegment> path_;
+        bool failed_ = false;
+    };
+}
+
+std::vector<SchemaViolation> Schema::validate(const var& document) const {
+    std::vector<SchemaViolation> violations;
+    SchemaValidation validation(*program_, &violations);
+    validation.check(0, document);
+    return violations;
+}
+
+bool Schema::isValid(const var& document) const {
+    SchemaValidation validation(*program_, nullptr);
+    validation.check(0, document);
+    return !validation.failed();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "HighCPP.h"
+
+struct SchemaProgram;
+
+// One failed check, located by its path from the document root ($.items[2].name)
+struct SchemaViolation {
+    std::string path;
+    std::string message;
+};
+
+// A document schema, written as a var and compiled once into a flat program of
+// nodes. Each node is a Table with any of these keys:
+//
+//   "type"                   type name or Array of names: Null, Int, Double, Number,
+//                            String, Array, Table (any keyed container), OrderedTable,
+//                            Record, Any
+//   "min", "max"             inclusive numeric bounds
+//   "minLength", "maxLength" String length bounds
+//   "minItems", "maxItems"   Array length bounds
+//   "items"                  schema for every Array element
+//   "properties"             Table of key -> schema
+//   "required"               Array of keys that must be present
+//   "additionalProperties"   0 rejects keys not listed in properties (default 1)
+//
+//   Schema schema = Schema::compile(var::makeTable(Table{
+//       { "type", var("Table") },
+//       { "required", var(Array{ var("id") }) },
+//       { "properties", var::makeTable(Table{
+//           { "id", var::makeTable(Table{ { "type", var("Int") }, { "min", var(0) } }) } }) } }));
+//   for (const SchemaViolation& v : schema.validate(document)) std::cerr << v.path << ": " << v.message;
+//
+// Validation walks the document once, borrowing every value, and collects every
+// violation. Invalid schemas throw std::invalid_argument from compile().
+// A compiled Schema is immutable and may be shared between threads.
+class Schema {
+public:
+    static Schema compile(const var& description);
+
+    std::vector<SchemaViolation> validate(const var& document) const;
+
+    // Stops at the first violation and builds no paths
+    bool isValid(const var& document) const;
+
+    size_t nodeCount() const;
+
+private:
+    explicit Schema(std::shared_ptr<const SchemaProgram> program) : program_(std::move(program)) {}
+
+    std::shared_ptr<const SchemaProgram> program_;
+};
@@ -0,0 +1,125 @@
+#include "Snapshot.h"
+
+#include <exception>
+#include <limits>
+#include <new>
+
+#ifdef __cpp_lib_hardware_interference_size
+static_assert(SnapshotPublisher::CacheLine >= std::hardware_destructive_interference_size,
+    "SnapshotPublisher::CacheLine is smaller than the target's cache line");
+#endif
+
+namespace {
+    // Epoch value of a slot whose reader is not inside a read
+    constexpr uint64_t kIdleEpoch = std::numeric_limits<uint64_t>::max();
+}
+
+// Each slot sits on its own cache line so readers never contend with each other
+struct alignas(SnapshotPublisher::CacheLine) SnapshotPublisher::Reader::Slot {
+    std::atomic<uint64_t> epoch{ kIdleEpoch };
+    bool claimed = false; // Guarded by the publisher mutex
+};
+
+// ------------------------ ReadGuard ------------------------
+
+SnapshotPublisher::ReadGuard::ReadGuard(ReadGuard&& other) noexcept
+    : reader_(std::exchange(other.reader_, nullptr)), snapshot_(other.snapshot_) {}
+
+SnapshotPublisher::ReadGuard::~ReadGuard() {
+    if (reader_) reader_->leave();
+}
+
+// ------------------------ Reader ------------------------
+
+SnapshotPublisher::Reader::Reader(Reader&& other) noexcept
+    : publisher_(std::exchange(other.publisher_, nullptr)), slot_(std::exchange(other.slot_, nullptr)), depth_(other.depth_) {
+    if (depth_ != 0) std::terminate(); // Moved with live guards
+}
+
+SnapshotPublisher::Reader::~Reader() {
+    if (depth_ != 0) std::terminate(); // Destroyed with live guards
+    if (!slot_) return;
+    slot_->epoch.store(kIdleEpoch, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(publisher_->mutex_);
+    slot_->claimed = false;
+}
+
+SnapshotPublisher::ReadGuard SnapshotPublisher::Reader::read() {
+    if (depth_++ == 0) {
+        // Announce the epoch before loading the pointer; both are sequentially
+        // consistent so a writer scanning slots either sees this epoch or
+        // published before the load below
+        slot_->epoch.store(publisher_->epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+    return ReadGuard(this, publisher_->current_.load(std::memory_order_seq_cst));
+}
+
+void SnapshotPublisher::Reader::leave() {
+    if (--depth_ == 0) slot_->epoch.store(kIdleEpoch, std::memory_order_release);
+}
+
+// ------------------------ SnapshotPublisher ------------------------
+
+SnapshotPublisher::SnapshotPublisher(var initial) : current_(new var(std::move(initial))) {}
+
+SnapshotPublisher::~SnapshotPublisher() {
+    delete current_.load(std::memory_order_relaxed);
+    for (const Retired& retired : retired_) delete retired.snapshot;
+}
+
+void SnapshotPublisher::publish(var next) {
+    const var* fresh = new var(std::move(next));
+    const var* old = current_.exchange(fresh, std::memory_order_seq_cst);
+    // Readers that announced this epoch or an earlier one may still hold old
+    uint64_t retiredAt = epoch_.fetch_add(1, std::memory_order_seq_cst);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    retired_.push_back({ retiredAt, old });
+    collectLocked();
+}
+
+SnapshotPublisher::Reader SnapshotPublisher::reader() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& slot : slots_) {
+        if (!slot->claimed) {
+            slot->claimed = true;
+            return Reader(this, slot.get());
+        }
+    }
+    slots_.push_back(std::make_unique<Reader::Slot>());
+    slots_.back()->claimed = true;
+    return Reader(this, slots_.back().get());
+}
+
+size_t SnapshotPublisher::collect() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return collectLocked();
+}
+
+size_t SnapshotPublisher::retiredCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return retired_.size();
+}
+
+size_t SnapshotPublisher::collectLocked() {
+    if (retired_.empty()) return 0;
+
+    uint64_t oldestActive = kIdleEpoch;
+    for (const auto& slot : slots_) {
+        oldestActive = std::min(oldestActive, slot->epoch.load(std::memory_order_seq_cst));
+    }
+
+    size_t freed = 0;
+    auto keep = retired_.begin();
+    for (auto it = retired_.begin(); it != retired_.end(); ++it) {
+        if (it->epoch < oldestActive) {
+            delete it->snapshot;
+            ++freed;
+        }
+        else {
+            *keep++ = *it;
+        }
+    }
+    retired_.erase(keep, retired_.end());
+    return freed;
+}
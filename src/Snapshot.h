@@ -0,0 +1,115 @@
+#pragma once
+
+#include "HighCPP.h"
+
+#include <atomic>
+#include <mutex>
+
+// Read-copy-update publication of immutable var snapshots. A writer swaps in a
+// whole new tree with publish(); readers pin the current tree without locks or
+// shared reference counts. Old trees are reclaimed by epochs: each reader
+// announces the epoch it entered in its own cache line, and a retired tree is
+// freed once every active reader entered after it was replaced.
+//
+//   SnapshotPublisher config(loadConfig());
+//   // on each reader thread, once:
+//   SnapshotPublisher::Reader reader = config.reader();
+//   // per request:
+//   auto snapshot = reader.read();
+//   var::getElement(*snapshot, "timeout");
+class SnapshotPublisher {
+public:
+    class Reader;
+
+    // Spacing that keeps two objects off one cache line. A fixed value, since the
+    // layout is part of this header's ABI; Snapshot.cpp checks it against
+    // std::hardware_destructive_interference_size where that is available.
+    static constexpr size_t CacheLine = 64;
+
+    // Pins one snapshot for the lifetime of the guard. A guard refers to the
+    // Reader that created it, so it must not outlive that Reader.
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ~ReadGuard();
+
+        const var& operator*() const { return *snapshot_; }
+        const var* operator->() const { return snapshot_; }
+        const var* get() const { return snapshot_; }
+
+    private:
+        friend class Reader;
+        ReadGuard(Reader* reader, const var* snapshot) : reader_(reader), snapshot_(snapshot) {}
+
+        Reader* reader_;
+        const var* snapshot_;
+    };
+
+    // Per-thread read handle owning one epoch slot. Obtaining a Reader takes a
+    // lock; reads through it are wait-free. Guards from the same Reader may nest,
+    // but a Reader must only be used by one thread at a time. Like a joinable
+    // std::thread, destroying or moving a Reader while any of its guards are
+    // alive calls std::terminate, since those guards would be left dangling.
+    class Reader {
+    public:
+        Reader(Reader&& other) noexcept;
+        Reader& operator=(Reader&&) = delete;
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        ~Reader();
+
+        ReadGuard read();
+
+    private:
+        friend class SnapshotPublisher;
+        friend class ReadGuard;
+        struct Slot;
+
+        Reader(SnapshotPublisher* publisher, Slot* slot) : publisher_(publisher), slot_(slot) {}
+        void leave();
+
+        SnapshotPublisher* publisher_;
+        Slot* slot_;
+        size_t depth_ = 0;
+    };
+
+    explicit SnapshotPublisher(var initial = var());
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+    // All Readers must be destroyed before the publisher
+    ~SnapshotPublisher();
+
+    // Atomically replaces the current snapshot and retires the old one
+    void publish(var next);
+
+    // Registers a reader slot for the calling thread
+    Reader reader();
+
+    // Frees retired snapshots that no reader can still see; returns how many were freed.
+    // publish() already does this, so calling it is only needed to release memory sooner.
+    size_t collect();
+
+    // Number of retired snapshots still waiting for readers to move on
+    size_t retiredCount() const;
+
+private:
+    struct Retired {
+        uint64_t epoch;
+        const var* snapshot;
+    };
+
+    size_t collectLocked();
+
+    // Read by every reader; kept apart from the writer-side state below, so
+    // taking the mutex does not invalidate the line readers load from
+    alignas(CacheLine) std::atomic<const var*> current_;
+    std::atomic<uint64_t> epoch_{ 1 };
+
+    alignas(CacheLine) mutable std::mutex mutex_; // Guards slots_ and retired_
+    std::vector<std::unique_ptr<Reader::Slot>> slots_;
+    std::vector<Retired> retired_;
+};
@@ -0,0 +1,93 @@
+#include "VarString.h"
+
+#include <new>
+
+VarString::VarString(std::string_view text) {
+    if (text.size() <= InlineCapacity) {
+        setEmpty();
+        std::memcpy(bytes_, text.data(), text.size());
+        bytes_[InlineCapacity] = static_cast<unsigned char>(InlineCapacity - text.size());
+        return;
+    }
+    Buffer* buf = allocate(text.size());
+    std::memcpy(buf->data(), text.data(), text.size());
+    adopt(buf);
+}
+
+VarString::VarString(const VarString& other) noexcept {
+    std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+    if (!isInline()) buffer()->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+VarString::VarString(VarString&& other) noexcept {
+    std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+    other.setEmpty();
+}
+
+VarString& VarString::operator=(const VarString& other) noexcept {
+    if (this != &other) {
+        // Take the new reference first so self-sharing strings stay alive
+        if (!other.isInline()) other.buffer()->refs.fetch_add(1, std::memory_order_relaxed);
+        release();
+        std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+    }
+    return *this;
+}
+
+VarString& VarString::operator=(VarString&& other) noexcept {
+    if (this != &other) {
+        release();
+        std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+        other.setEmpty();
+    }
+    return *this;
+}
+
+VarString VarString::concat(std::string_view a, std::string_view b) {
+    size_t size = a.size() + b.size();
+    if (size <= InlineCapacity) {
+        char text[InlineCapacity];
+        std::memcpy(text, a.data(), a.size());
+        std::memcpy(text + a.size(), b.data(), b.size());
+        return VarString(std::string_view(text, size));
+    }
+    VarString result;
+    Buffer* buf = allocate(size);
+    std::memcpy(buf->data(), a.data(), a.size());
+    std::memcpy(buf->data() + a.size(), b.data(), b.size());
+    result.adopt(buf);
+    return result;
+}
+
+// A string whose hash really is 0 is rehashed on every call, which is still correct
+size_t VarString::heapHash() const noexcept {
+    Buffer* buf = buffer();
+    size_t hash = buf->hash.load(std::memory_order_relaxed);
+    if (hash == 0) {
+        hash = std::hash<std::string_view>()(view());
+        buf->hash.store(hash, std::memory_order_relaxed);
+    }
+    return hash;
+}
+
+VarString::Buffer* VarString::allocate(size_t size) {
+    void* memory = ::operator new(sizeof(Buffer) + size + 1);
+    Buffer* buf = new (memory) Buffer{ { 1 }, size, 0 };
+    buf->data()[size] = '\0';
+    return buf;
+}
+
+void VarString::adopt(Buffer* buf) noexcept {
+    std::memset(bytes_, 0, sizeof(bytes_));
+    std::memcpy(bytes_, &buf, sizeof(buf));
+    bytes_[InlineCapacity] = HeapTag;
+}
+
+void VarString::release() noexcept {
+    if (isInline()) return;
+    Buffer* buf = buffer();
+    if (buf->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        buf->~Buffer();
+        ::operator delete(buf);
+    }
+}
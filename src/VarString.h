@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Immutable string used for var String values and Table keys. Strings of up to
+// 15 characters are stored inline in the 16-byte object; longer ones live in a
+// reference-counted heap buffer that copies share, so copying is O(1) either way.
+// A heap buffer computes its hash on the first hash() call and caches it, so
+// strings never used as keys never pay for hashing. Strings that share a buffer
+// compare equal without looking at the characters.
+class VarString {
+public:
+    static constexpr size_t InlineCapacity = 15;
+
+    VarString() noexcept { setEmpty(); }
+    VarString(const char* text) : VarString(std::string_view(text)) {}
+    VarString(const std::string& text) : VarString(std::string_view(text)) {}
+    explicit VarString(std::string_view text);
+
+    VarString(const VarString& other) noexcept;
+    VarString(VarString&& other) noexcept;
+    VarString& operator=(const VarString& other) noexcept;
+    VarString& operator=(VarString&& other) noexcept;
+    ~VarString() { release(); }
+
+    size_t size() const noexcept { return isInline() ? InlineCapacity - bytes_[InlineCapacity] : buffer()->size; }
+    bool empty() const noexcept { return size() == 0; }
+
+    // Always null-terminated
+    const char* data() const noexcept { return isInline() ? reinterpret_cast<const char*>(bytes_) : buffer()->data(); }
+    const char* c_str() const noexcept { return data(); }
+
+    std::string_view view() const noexcept { return { data(), size() }; }
+    operator std::string_view() const noexcept { return view(); }
+    std::string str() const { return std::string(view()); }
+    explicit operator std::string() const { return str(); } // Copies, so only on request
+
+    // Same value as std::hash<std::string_view> of the characters
+    size_t hash() const noexcept { return isInline() ? std::hash<std::string_view>()(view()) : heapHash(); }
+
+    bool isInline() const noexcept { return bytes_[InlineCapacity] != HeapTag; }
+
+    // Number of VarStrings sharing this string's buffer; 1 for inline strings
+    size_t useCount() const noexcept { return isInline() ? 1 : buffer()->refs.load(std::memory_order_relaxed); }
+
+    // Builds a + b with a single allocation
+    static VarString concat(std::string_view a, std::string_view b);
+
+    friend bool operator==(const VarString& a, const VarString& b) noexcept {
+        if (!a.isInline() && !b.isInline()) {
+            if (a.buffer() == b.buffer()) return true;
+            // Differing hashes settle it, but only once both have been computed
+            size_t hashA = a.buffer()->hash.load(std::memory_order_relaxed);
+            size_t hashB = b.buffer()->hash.load(std::memory_order_relaxed);
+            if (hashA != 0 && hashB != 0 && hashA != hashB) return false;
+        }
+        return a.view() == b.view();
+    }
+    friend bool operator==(const VarString& a, std::string_view b) noexcept { return a.view() == b; }
+    friend bool operator==(const VarString& a, const std::string& b) noexcept { return a.view() == b; }
+    friend bool operator==(const VarString& a, const char* b) noexcept { return a.view() == b; }
+    friend std::strong_ordering operator<=>(const VarString& a, const VarString& b) noexcept { return a.view() <=> b.view(); }
+    friend std::strong_ordering operator<=>(const VarString& a, std::string_view b) noexcept { return a.view() <=> b; }
+
+    friend std::ostream& operator<<(std::ostream& os, const VarString& text) { return os << text.view(); }
+
+private:
+    static constexpr unsigned char HeapTag = 0x80;
+
+    // Header of a heap string; the characters and a terminating null follow it
+    struct Buffer {
+        std::atomic<size_t> refs;
+        size_t size;
+        std::atomic<size_t> hash; // 0 until hash() computes it; racing threads store the same value
+
+        char* data() noexcept { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    Buffer* buffer() const noexcept {
+        Buffer* ptr;
+        std::memcpy(&ptr, bytes_, sizeof(ptr));
+        return ptr;
+    }
+
+    // The last inline byte holds InlineCapacity - size, so a full inline string
+    // ends with the zero that terminates it; heap strings mark it with HeapTag
+    void setEmpty() noexcept {
+        std::memset(bytes_, 0, sizeof(bytes_));
+        bytes_[InlineCapacity] = InlineCapacity;
+    }
+
+    size_t heapHash() const noexcept;
+
+    static Buffer* allocate(size_t size);
+    void adopt(Buffer* buffer) noexcept;
+    void release() noexcept;
+
+    alignas(void*) unsigned char bytes_[InlineCapacity + 1];
+};
+
+// Hash and equality for unordered containers keyed by VarString; transparent, so
+// lookups by std::string, std::string_view or const char* allocate nothing
+struct VarStringHash {
+    using is_transparent = void;
+
+    size_t operator()(const VarString& text) const noexcept { return text.hash(); }
+    size_t operator()(std::string_view text) const noexcept { return std::hash<std::string_view>()(text); }
+    size_t operator()(const std::string& text) const noexcept { return std::hash<std::string_view>()(text); }
+    size_t operator()(const char* text) const noexcept { return std::hash<std::string_view>()(text); }
+};
+
+struct VarStringEqual {
+    using is_transparent = void;
+
+    bool operator()(const VarString& a, const VarString& b) const noexcept { return a == b; }
+    bool operator()(const VarString& a, std::string_view b) const noexcept { return a.view() == b; }
+    bool operator()(std::string_view a, const VarString& b) const noexcept { return a == b.view(); }
+    bool operator()(const VarString& a, const std::string& b) const noexcept { return a.view() == b; }
+    bool operator()(const std::string& a, const VarString& b) const noexcept { return a == b.view(); }
+    bool operator()(const VarString& a, const char* b) const noexcept { return a.view() == b; }
+    bool operator()(const char* a, const VarString& b) const noexcept { return a == b.view(); }
+};
+
+template <>
+struct std::hash<VarString> {
+    size_t operator()(const VarString& text) const noexcept { return text.hash(); }
+};
@@ -0,0 +1,70 @@
+#include "HighCPP.h"
+#include "Check.h"
+
+#include <string>
+
+int main() {
+    const std::string longText(64, 'q');
+
+    // The size hint reserves once; appends and emplaces fill it without reallocating
+    ArrayBuilder arrays(100);
+    for (int i = 0; i < 98; ++i) arrays.append(var(i));
+    arrays.emplace(2.5);
+    var text(longText);
+    arrays.append(std::move(text));
+    CHECK(arrays.size() == 100);
+
+    var built = arrays.build();
+    CHECK(arrays.size() == 0);
+    const Array& arr = built.getArray();
+    CHECK(arr.size() == 100 && arr.capacity() == 100);
+    CHECK(arr[97].getInt() == 97 && arr[98].getDouble() == 2.5);
+    CHECK(arr[99].getString().useCount() == 1); // Moved, not copied: a copy would share the buffer with text
+
+    // A builder can be reused after build()
+    arrays.reserve(2).append(var(1)).append(var(2));
+    CHECK(var::len(arrays.build()) == 2);
+
+    // Tables: set replaces, emplace constructs in place or replaces
+    TableBuilder tables(3);
+    tables.set("a", var(1)).set(std::string("b"), var(longText));
+    tables.emplace("c", 3);
+    tables.emplace("a", "replaced");
+    tables.set("b", var(2));
+    CHECK(tables.size() == 3);
+    var tbl = tables.build();
+    CHECK(tables.size() == 0);
+    CHECK(var::getElement(tbl, "a").getString() == "replaced");
+    CHECK(var::getElement(tbl, "b").getInt() == 2);
+    CHECK(var::getElement(tbl, "c").getInt() == 3);
+
+    // Move overloads hand buffers over instead of copying them
+    var target = var::newArray(Array());
+    var moving(longText);
+    var::appendElement(target, std::move(moving));
+    CHECK(target.getArray()[0].getString().useCount() == 1);
+    var replacement(longText + "!");
+    var::setElement(target, 0, std::move(replacement));
+    CHECK(target.getArray()[0].getString().useCount() == 1 && target.getArray()[0].getString() == longText + "!");
+    var copied(longText);
+    var::appendElement(target, copied);
+    CHECK(copied.getString().useCount() == 2); // The const overload shares the buffer instead
+    var::setElement(target, 3, var(1)); // Setting past the end grows the Array with nulls
+    CHECK(var::len(target) == 4 && target.getArray()[2].isNull());
+
+    var keyed = var::newTable(Table());
+    var value(longText);
+    var::setElement(keyed, "k", std::move(value));
+    CHECK(keyed.getTable().at("k").getString().useCount() == 1);
+
+    // range and slice produce exactly sized results
+    var numbers = var::range(0, 10, 1);
+    CHECK(var::len(numbers) == 10 && numbers.getArray().capacity() == 10);
+    var odd = var::slice(numbers, 1, 10, 2);
+    CHECK(var::len(odd) == 5 && odd.getArray()[4].getInt() == 9 && odd.getArray().capacity() == 5);
+    var reversed = var::slice(numbers, -1, 0, -3);
+    CHECK(var::len(reversed) == 3 && reversed.getArray()[2].getInt() == 3 && reversed.getArray().capacity() == 3);
+    CHECK(var::len(var::slice(numbers, 5, 2, 1)) == 0 && var::len(var::slice(numbers, 2, 50, 4)) == 2);
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+// Minimal checks for the test executables; unlike assert they stay on in release builds
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+            std::exit(1); \
+        } \
+    } while (false)
+
+#define CHECK_THROWS(expression, Exception) \
+    do { \
+        bool thrown = false; \
+        try { (void)(expression); } \
+        catch (const Exception&) { thrown = true; } \
+        if (!thrown) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " #expression " did not throw " #Exception << std::endl; \
+            std::exit(1); \
+        } \
+    } while (false)
@@ -0,0 +1,107 @@
+#include "HighCPP.h"
+#include "Columnar.h"
+#include "Check.h"
+
+#include <string>
+
+namespace {
+    var row(std::initializer_list<std::pair<std::string, var>> entries) {
+        Table tbl;
+        for (const auto& [key, value] : entries) tbl.emplace(key, value);
+        return var(std::move(tbl));
+    }
+}
+
+int main() {
+    // Column types follow the values; missing keys and Nulls become null cells
+    Array rows;
+    for (int i = 0; i < 130; ++i) {
+        if (i % 10 == 0) rows.push_back(row({ { "id", var(i) }, { "score", var() } }));
+        else rows.push_back(row({ { "id", var(i) }, { "score", i % 2 ? var(i) : var(i + 0.5) }, { "name", var("n" + std::to_string(i)) } }));
+    }
+    rows.push_back(row({ { "id", var(130) }, { "tag", var(1) } }));
+    rows.push_back(row({ { "id", var(131) }, { "tag", var("x") } }));
+    ColumnarTable table = var::toColumnar(var(rows));
+
+    CHECK(table.rowCount() == 132);
+    const Column& id = table.column("id");
+    const Column& score = table.column("score");
+    const Column& name = table.column("name");
+    CHECK(id.type() == ColumnType::Int && id.nullCount() == 0);
+    CHECK(name.type() == ColumnType::String);
+    CHECK(table.column("tag").type() == ColumnType::Mixed);
+
+    // Ints mixed with Doubles promote to a Double column
+    CHECK(score.type() == ColumnType::Double);
+    CHECK(score.doubles()[1] == 1.0);
+    CHECK(score.doubles()[2] == 2.5);
+    CHECK(score.get(3).isDouble() && score.get(3).getDouble() == 3.0);
+
+    // Validity bitmap: one bit per row across word boundaries, nulls hold defaults
+    CHECK(score.validity().size() == 3);
+    CHECK(score.nullCount() == 13 + 2);
+    CHECK(score.isNull(0) && score.isNull(120) && score.isNull(131));
+    CHECK(!score.isNull(1) && !score.isNull(127));
+    CHECK(score.get(0).isNull());
+    CHECK(score.doubles()[0] == 0.0);
+    CHECK((score.validity()[1] & (uint64_t(1) << (120 - 64))) == 0);
+    CHECK((score.validity()[1] & (uint64_t(1) << (121 - 64))) != 0);
+    CHECK(name.nullCount() == 13 + 2);
+    CHECK(name.strings()[0].empty());
+
+    // Aggregates skip nulls
+    CHECK(table.count("score") == 132 - 15);
+    CHECK(table.min("score").getDouble() == 1.0);
+    CHECK(table.max("score").getDouble() == 129.0);
+    CHECK(table.count("id") == 132);
+    CHECK(table.max("id").getInt() == 131);
+    CHECK_THROWS(table.sum("name"), std::runtime_error);
+
+    // Filters see only present cells; take keeps the null pattern
+    std::vector<size_t> high = table.where("score", [](double cell) { return cell > 125.0; });
+    CHECK((high == std::vector<size_t>{ 126, 127, 128, 129 }));
+    ColumnarTable picked = table.take({ 0, 126 });
+    CHECK(picked.rowCount() == 2);
+    CHECK(picked.column("score").isNull(0) && !picked.column("score").isNull(1));
+    CHECK(picked.column("score").nullCount() == 1);
+
+    // Null cells are left out of the rows again
+    var back = table.toRows(RowKind::OrderedTable);
+    CHECK(var::len(back.getArray()[0]) == 1);
+    CHECK(var::getElement(back.getArray()[1], "score").getDouble() == 1.0);
+
+    // Column edits keep the null count in step with the bitmap
+    Column column(ColumnType::Double);
+    column.append(var(1));
+    column.appendNull();
+    column.append(var(2.5));
+    CHECK(column.size() == 3 && column.nullCount() == 1);
+    column.set(1, var(4));
+    CHECK(column.nullCount() == 0 && column.doubles()[1] == 4.0);
+    column.set(0, var());
+    CHECK(column.nullCount() == 1 && column.isNull(0));
+    column.resize(70);
+    CHECK(column.nullCount() == 68);
+    column.resize(2);
+    CHECK(column.nullCount() == 1);
+
+    Column more(ColumnType::Double);
+    more.appendNull();
+    more.append(var(7.0));
+    column.extend(std::move(more));
+    CHECK(column.size() == 4 && column.nullCount() == 2 && column.doubles()[3] == 7.0);
+    CHECK_THROWS(column.extend(Column(ColumnType::Int)), std::invalid_argument);
+    CHECK_THROWS(column.set(0, var("text")), std::bad_variant_access);
+
+    // A rejected append leaves the column as it was
+    CHECK(!column.accepts(var("text")) && column.accepts(var(1)) && column.accepts(var()));
+    CHECK_THROWS(column.append(var("text")), std::bad_variant_access);
+    var rejected("text");
+    CHECK_THROWS(column.append(std::move(rejected)), std::bad_variant_access);
+    CHECK(column.size() == 4 && column.nullCount() == 2);
+    Column ints(ColumnType::Int);
+    CHECK_THROWS(ints.append(var(1.5)), std::bad_variant_access);
+    CHECK(ints.size() == 0 && ints.nullCount() == 0);
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "HighCPP.h"
+#include "Csv.h"
+#include "Check.h"
+
+#include <string>
+
+namespace {
+    // Rows whose quoted fields hold delimiters, newlines and doubled quotes
+    std::string quotedCsv(int rows) {
+        std::string text = "id,note,score\n";
+        for (int i = 0; i < rows; ++i) {
+            text += std::to_string(i) + ",\"line one, " + std::to_string(i) + "\nline \"\"two\"\"\"," +
+                std::to_string(i) + ".5\n";
+        }
+        return text;
+    }
+
+    std::string expectedNote(int i) {
+        return "line one, " + std::to_string(i) + "\nline \"two\"";
+    }
+}
+
+int main() {
+    // Tiny chunks put nominal split points inside quoted fields; every row must still parse whole
+    const int kRows = 500;
+    const std::string text = quotedCsv(kRows);
+    for (size_t chunkSize : { size_t(7), size_t(64), size_t(1000), size_t(8) << 20 }) {
+        CsvOptions options;
+        options.chunkSize = chunkSize;
+        options.threads = 4;
+
+        var rows = parseCsv(text, options);
+        CHECK(var::len(rows) == kRows);
+        const Array& arr = rows.getArray();
+        for (int i = 0; i < kRows; ++i) {
+            CHECK(var::getElement(arr[i], "id").getInt() == i);
+            CHECK(var::getElement(arr[i], "note").getString() == expectedNote(i));
+            CHECK(var::getElement(arr[i], "score").getDouble() == i + 0.5);
+        }
+
+        ColumnarTable columns = parseCsvColumnar(text, options);
+        CHECK(columns.rowCount() == kRows);
+        CHECK(columns.column("id").type() == ColumnType::Int);
+        CHECK(columns.column("note").type() == ColumnType::String);
+        CHECK(columns.column("score").type() == ColumnType::Double);
+        CHECK(columns.column("note").strings()[kRows - 1] == expectedNote(kRows - 1));
+    }
+
+    // Cell typing: only text that starts like a number becomes one
+    var typed = parseCsv("a,b,c,d,e,f,g,h\n12,-3,.5,-.25,1e3,nan,inf,\"7\"\nInfinity,-nan,+1,x1,1x,-,.,\n");
+    const Array& cells = typed.getArray();
+    CHECK(var::getElement(cells[0], "a").getInt() == 12);
+    CHECK(var::getElement(cells[0], "b").getInt() == -3);
+    CHECK(var::getElement(cells[0], "c").getDouble() == 0.5);
+    CHECK(var::getElement(cells[0], "d").getDouble() == -0.25);
+    CHECK(var::getElement(cells[0], "e").getDouble() == 1000.0);
+    CHECK(var::getElement(cells[0], "f").getString() == "nan");
+    CHECK(var::getElement(cells[0], "g").getString() == "inf");
+    CHECK(var::getElement(cells[0], "h").getString() == "7");
+    const char* names[] = { "a", "b", "c", "d", "e", "f", "g" };
+    const char* words[] = { "Infinity", "-nan", "+1", "x1", "1x", "-", "." };
+    for (size_t c = 0; c < 7; ++c) CHECK(var::getElement(cells[1], names[c]).getString() == words[c]);
+    CHECK(var::getElement(cells[1], "h").isNull());
+
+    // A column with nan and inf among numbers stays text instead of becoming Double
+    ColumnarTable mixed = parseCsvColumnar("v\n1.5\nnan\ninf\n2\n");
+    CHECK(mixed.column("v").type() == ColumnType::String);
+    CHECK(mixed.column("v").strings()[1] == "nan");
+    ColumnarTable numbers = parseCsvColumnar("k,v\n1,1.5\n2,\n3,2\n");
+    CHECK(numbers.column("v").type() == ColumnType::Double);
+    CHECK(numbers.column("v").nullCount() == 1);
+
+    // Malformed quoting is reported
+    CHECK_THROWS(parseCsv("a\n\"open\n"), std::runtime_error);
+    CHECK_THROWS(parseCsv("a\n\"x\"y\n"), std::runtime_error);
+
+    return 0;
+}
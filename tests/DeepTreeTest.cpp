@@ -0,0 +1,39 @@
+#include "HighCPP.h"
+#include "Check.h"
+
+#include <sstream>
+
+// Copying, printing and destroying must not recurse once per nesting level
+int main() {
+    constexpr int kDepth = 1000000;
+
+    var deep;
+    for (int i = 0; i < kDepth; ++i) {
+        Array wrapper;
+        wrapper.emplace_back(std::move(deep));
+        deep = var(std::move(wrapper));
+    }
+    var deepCopy = deep;
+    std::ostringstream deepText;
+    deepText << deepCopy;
+    CHECK(deepText.str().size() == static_cast<size_t>(kDepth) * 4 + 4); // "[ " ... "Null" ... " ]"
+    deep = var();
+    deepCopy = var();
+
+    var chain = makeInt(0);
+    for (int i = 0; i < kDepth; ++i) {
+        chain = var(std::make_shared<var>(std::move(chain)));
+    }
+    var chainCopy = chain;
+    std::ostringstream chainText;
+    chainText << chainCopy;
+    CHECK(chainText.str().size() == static_cast<size_t>(kDepth) * 9 + 1); // "Pointer(" ... "0" ... ")"
+    chain = var();
+    chainCopy = var();
+
+    // Assigning a child over its own parent keeps the child alive
+    var self = var(Array{ var(Array{ var(7) }) });
+    self = self.getArray()[0];
+    CHECK(self.isArray() && self.getArray()[0].getInt() == 7);
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "HighCPP.h"
+#include "Expression.h"
+#include "Check.h"
+
+#include <climits>
+#include <string>
+
+namespace {
+    // The message of the compile error for source, or "" if it compiles
+    std::string compileError(const std::string& source) {
+        try {
+            Expression::compile(source);
+        }
+        catch (const std::invalid_argument& error) {
+            return error.what();
+        }
+        return "";
+    }
+
+    var eval(const std::string& source, const var& input = var()) {
+        return Expression::compile(source).evaluate(input);
+    }
+}
+
+int main() {
+    // Compile errors name the column of the offending token
+    CHECK(compileError("1 +") == "Expression error at column 4: unexpected end of expression");
+    CHECK(compileError("(1 + 2") == "Expression error at column 7: expected ')'");
+    CHECK(compileError("a ? b") == "Expression error at column 3: unexpected '?'");
+    CHECK(compileError("foo(1)").find("unknown function 'foo'") != std::string::npos);
+    CHECK(compileError("len(1, 2)").find("wrong number of arguments to len") != std::string::npos);
+    CHECK(compileError("'open").find("unterminated string") != std::string::npos);
+    CHECK(compileError("1.2.3").find("invalid number '1.2.3'") != std::string::npos);
+    CHECK(compileError("a.(b)").find("expected field name") != std::string::npos);
+    CHECK(compileError("1 + 2 * (3 - 4)") == "");
+
+    // Evaluation errors use the var exceptions
+    Table fields;
+    fields.emplace("x", var(4));
+    fields.emplace("name", var("abc"));
+    var row(fields);
+    CHECK_THROWS(eval("missing", row), std::out_of_range);
+    CHECK_THROWS(eval("x / 0", row), std::domain_error);
+    CHECK_THROWS(eval("name - 1", row), std::runtime_error);
+    CHECK_THROWS(eval("name < 1", row), std::runtime_error);
+    CHECK_THROWS(eval("range(0, 3)[5]"), std::out_of_range);
+
+    // Int literals: -2147483648 folds to INT_MIN; 2147483648 alone is a Double
+    var minInt = eval("-2147483648");
+    CHECK(minInt.isInt() && minInt.getInt() == INT_MIN);
+    var tooBig = eval("2147483648");
+    CHECK(tooBig.isDouble() && tooBig.getDouble() == 2147483648.0);
+    CHECK(eval("2147483647").getInt() == INT_MAX);
+    CHECK(eval("-2147483648 - 1").getDouble() == -2147483649.0);
+    CHECK(eval("- -2147483648").getDouble() == 2147483648.0);
+    CHECK(eval("-(2147483648)").getDouble() == -2147483648.0);
+    CHECK(eval("-x", row).getInt() == -4);
+
+    // Arithmetic and comparison follow the var operators
+    CHECK(eval("x * 3 + 1", row).getInt() == 13);
+    CHECK(eval("x / 3", row).getInt() == 1);
+    CHECK(eval("x / 8.0", row).getDouble() == 0.5);
+    CHECK(eval("2147483647 + 1").getDouble() == 2147483648.0);
+    CHECK(eval("name + 'def' == 'abcdef'", row).getInt() == 1);
+    CHECK(eval("x == 4.0", row).getInt() == 1);
+    CHECK(eval("name == 4", row).getInt() == 0);
+    CHECK(eval("null == null").getInt() == 1);
+
+    // Containers compare structurally
+    CHECK(eval("range(0, 3) == range(0, 3)").getInt() == 1);
+    CHECK(eval("range(0, 3) != range(0, 4)").getInt() == 1);
+    CHECK(eval("slice(range(0, 5), 1, 2) == range(1, 2)").getInt() == 1);
+    CHECK(eval("$ == $", row).getInt() == 1);
+    CHECK_THROWS(eval("range(0, 3) < range(0, 4)"), std::runtime_error);
+
+    // An evaluator reuses its registers across rows
+    Expression rule = Expression::compile("x > 2 && len(name) == 3");
+    ExpressionEvaluator evaluator(rule);
+    CHECK(evaluator.evaluate(row).getInt() == 1);
+    Table other;
+    other.emplace("x", var(1));
+    other.emplace("name", var("abc"));
+    CHECK(evaluator.evaluate(var(other)).getInt() == 0);
+
+    return 0;
+}
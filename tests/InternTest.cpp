@@ -0,0 +1,87 @@
+#include "HighCPP.h"
+#include "Intern.h"
+#include "Check.h"
+
+#include <string>
+
+namespace {
+    // Bytes a heap VarString buffer of this length frees: refs, size and hash, then text and null
+    size_t bufferBytes(size_t length) {
+        return 3 * sizeof(size_t) + length + 1;
+    }
+
+    var row(int id, const std::string& name) {
+        var tbl = var::newTable(Table{});
+        var::setElement(tbl, "id", var(id));
+        var::setElement(tbl, "name", var(name));
+        return tbl;
+    }
+}
+
+int main() {
+    // Repeated long strings: each duplicate frees its own buffer
+    {
+        var tree = var::newArray(Array{});
+        const std::string text(400, 'x');
+        for (int i = 0; i < 10; ++i) var::appendElement(tree, var(std::string(text)));
+        CHECK(var::dedupe(tree) == 9 * bufferBytes(400));
+        CHECK(tree.getArray()[0].getString().useCount() == 10);
+        CHECK(!tree.isShared());
+    }
+
+    // Distinct strings that the pool keeps do not eat into the savings
+    {
+        var tree = var::newArray(Array{});
+        for (int i = 0; i < 1000; ++i) {
+            std::string text = "distinct-string-" + std::to_string(i);
+            text.resize(41, '.');
+            var::appendElement(tree, var(text));
+        }
+        const std::string repeated(240, 'r');
+        for (int i = 0; i < 10; ++i) var::appendElement(tree, var(std::string(repeated)));
+        CHECK(var::dedupe(tree) == 9 * bufferBytes(240));
+        CHECK(tree.getArray()[1000].getString().useCount() == 10);
+        CHECK(tree.getArray()[0].getString().useCount() == 1);
+    }
+
+    // Short strings live inline and are never shared or counted
+    {
+        var tree = var::newArray(Array{});
+        for (int i = 0; i < 100; ++i) var::appendElement(tree, var("short"));
+        CHECK(var::dedupe(tree) == 0);
+    }
+
+    // Equal subtrees become one Shared node; a single occurrence is unwrapped again
+    {
+        var tree = var::newArray(Array{});
+        for (int i = 0; i < 5; ++i) var::appendElement(tree, row(1, "same"));
+        var::appendElement(tree, row(2, "other"));
+        CHECK(var::dedupe(tree) > 0);
+        const Array& rows = tree.getArray();
+        CHECK(rows[0].isShared() && rows[4].isShared());
+        CHECK(rows[0].getShared() == rows[4].getShared());
+        CHECK(!rows[5].isShared());
+        CHECK(var::getElement(rows[5], "id").getInt() == 2);
+    }
+
+    // A pool keeps its canonical values across calls and counts hits
+    {
+        InternPool pool;
+        var first = pool.intern(row(1, "a long name that goes on the heap"));
+        CHECK(pool.nodeCount() == 1);
+        CHECK(pool.size() == 2);
+        CHECK(pool.hits() == 0);
+
+        var second = row(1, "a long name that goes on the heap");
+        size_t saved = pool.internInPlace(second);
+        CHECK(saved > 0);
+        CHECK(saved == pool.duplicateBytes());
+        CHECK(pool.hits() == 2); // The string, then the table holding it
+        CHECK(first.getShared() == second.getShared());
+
+        pool.clear();
+        CHECK(pool.size() == 0 && pool.hits() == 0 && pool.duplicateBytes() == 0);
+    }
+
+    return 0;
+}
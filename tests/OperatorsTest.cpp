@@ -0,0 +1,122 @@
+#include "HighCPP.h"
+#include "Operators.h"
+#include "Check.h"
+
+#include <climits>
+#include <string>
+
+namespace {
+    var ints(std::initializer_list<int> values) {
+        Array arr;
+        for (int value : values) arr.emplace_back(value);
+        return var(std::move(arr));
+    }
+
+    // An Array nested depth levels deep
+    var wrap(int depth) {
+        var node;
+        for (int i = 0; i < depth; ++i) {
+            Array arr;
+            arr.push_back(std::move(node));
+            node = var(std::move(arr));
+        }
+        return node;
+    }
+
+    var point(int x, int y) {
+        Table tbl;
+        tbl.emplace("x", var(x));
+        tbl.emplace("y", var(y));
+        return var(std::move(tbl));
+    }
+}
+
+int main() {
+    // Scalars: int stays Int, overflow and mixed operands become Double
+    CHECK(var(var(7) / 2).getInt() == 3);
+    CHECK(var(var(7) % 3).getInt() == 1);
+    CHECK(var(var(7) / 2.0).getDouble() == 3.5);
+    var overflow = var(INT_MAX) + 1;
+    CHECK(overflow.isDouble() && overflow.getDouble() == 2147483648.0);
+    CHECK(var(-var(INT_MIN)).getDouble() == 2147483648.0);
+    CHECK_THROWS(var(var(1) / 0), std::domain_error);
+    CHECK_THROWS(var(var(1) % 0), std::domain_error);
+    CHECK(var(var(1.0) / 0).getDouble() > 1e308);
+
+    // Strings concatenate and order; other combinations throw
+    CHECK(var(var("abc") + var("def")).getString() == "abcdef");
+    CHECK(var(var("abc") < var("abd")).getInt() == 1);
+    CHECK_THROWS(var(var("abc") - var("a")), std::runtime_error);
+    CHECK_THROWS(var(var("abc") < 1), std::runtime_error);
+
+    // Array with scalar, Array with Array, and nested Arrays broadcast
+    var a = ints({ 1, 2, 3 });
+    var b = ints({ 10, 20, 30 });
+    var scaled = a * 2 + 1;
+    CHECK(var::len(scaled) == 3 && scaled.getArray()[2].getInt() == 7);
+    var sum = a + b;
+    CHECK(sum.getArray()[0].getInt() == 11 && sum.getArray()[2].getInt() == 33);
+    var flipped = 100 - a;
+    CHECK(flipped.getArray()[0].getInt() == 99);
+    var mixed = a * 0.5;
+    CHECK(mixed.getArray()[1].getDouble() == 1.0);
+    var mask = a > 1;
+    CHECK(mask.getArray()[0].getInt() == 0 && mask.getArray()[2].getInt() == 1);
+    var negated = -a;
+    CHECK(negated.getArray()[1].getInt() == -2);
+
+    Array nestedValues;
+    nestedValues.push_back(ints({ 1, 2 }));
+    nestedValues.push_back(var(3));
+    var nested(std::move(nestedValues));
+    var nestedSum = nested + 10;
+    CHECK(nestedSum.getArray()[0].getArray()[1].getInt() == 12);
+    CHECK(nestedSum.getArray()[1].getInt() == 13);
+
+    CHECK_THROWS(var(a + ints({ 1, 2 })), std::invalid_argument);
+    CHECK_THROWS(var(a / ints({ 1, 0, 1 })), std::domain_error);
+
+    // Compound assignment and operands used on both sides
+    var total = ints({ 1, 1 });
+    total += total;
+    total *= 3;
+    CHECK(total.getArray()[0].getInt() == 6);
+
+    // == on Tables is structural, regardless of table kind or entry order
+    var p1 = point(1, 2);
+    var p2 = point(1, 2);
+    var p3 = point(1, 3);
+    CHECK(var(p1 == p2).getInt() == 1);
+    CHECK(var(p1 != p2).getInt() == 0);
+    CHECK(var(p1 == p3).getInt() == 0);
+    var ordered(OrderedTable{ { "y", var(2) }, { "x", var(1.0) } });
+    CHECK(var(p1 == ordered).getInt() == 1);
+    var record = var::toRecord(ordered);
+    CHECK(var(record == p2).getInt() == 1);
+    CHECK(var(p1 == var()).getInt() == 0);
+    CHECK(var(var() == var()).getInt() == 1);
+    CHECK(var(p1 == 1).getInt() == 0);
+    CHECK_THROWS(var(p1 < p2), std::runtime_error);
+
+    // Arrays broadcast ==; equals compares them whole, nested and deep
+    var rows1 = var(Array{ p1, var("s"), ints({ 1, 2 }) });
+    var rows2 = var(Array{ p2, var("s"), ints({ 1, 2 }) });
+    var eqRows = rows1 == rows2;
+    CHECK(eqRows.getArray()[0].getInt() == 1);
+    CHECK(varops::equals(rows1, rows2));
+    CHECK(!varops::equals(rows1, var(Array{ p3, var("s"), ints({ 1, 2 }) })));
+    CHECK(!varops::equals(a, ints({ 1, 2 })));
+    CHECK(varops::equals(var(1), var(1.0)));
+    CHECK(!varops::equals(var("1"), var(1)));
+
+    var deep1 = wrap(100000);
+    var deep2 = wrap(100000);
+    CHECK(varops::equals(deep1, deep2));
+
+    // Values with no comparable content throw
+    var pointer = var::makePointer(var(1));
+    CHECK_THROWS(varops::equals(pointer, pointer), std::runtime_error);
+    CHECK_THROWS(varops::equals(var(Array{ var(1), pointer }), var(Array{ var(1), pointer })), std::runtime_error);
+
+    return 0;
+}
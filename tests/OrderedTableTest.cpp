@@ -0,0 +1,98 @@
+#include "HighCPP.h"
+#include "Check.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    std::vector<std::string> keysOf(const OrderedTable& tbl) {
+        std::vector<std::string> keys;
+        for (const auto& [key, value] : tbl) keys.push_back(key);
+        return keys;
+    }
+}
+
+int main() {
+    // Two vectors plus the index pointer; must not make var larger than Table does
+    CHECK(sizeof(OrderedTable) <= 2 * sizeof(std::vector<var>) + sizeof(void*));
+
+    OrderedTable tbl{ { "c", var(1) }, { "a", var(2) }, { "b", var(3) } };
+    CHECK((keysOf(tbl) == std::vector<std::string>{ "c", "a", "b" }));
+
+    // Replacing keeps the position, new keys go to the end
+    CHECK(!tbl.insert_or_assign("a", var(20)));
+    CHECK(tbl.insert_or_assign("d", var(4)));
+    CHECK((keysOf(tbl) == std::vector<std::string>{ "c", "a", "b", "d" }));
+    CHECK(tbl.at("a").getInt() == 20);
+
+    // Erasing keeps the order of the rest; a reinserted key goes to the end
+    CHECK(tbl.erase("c"));
+    CHECK(!tbl.erase("c"));
+    CHECK(tbl.insert_or_assign("c", var(5)));
+    CHECK((keysOf(tbl) == std::vector<std::string>{ "a", "b", "d", "c" }));
+    CHECK(tbl.at("c").getInt() == 5 && tbl.at("b").getInt() == 3);
+    CHECK(!tbl.contains("zz") && tbl.find("zz") == nullptr);
+    CHECK_THROWS(tbl.at("zz"), std::out_of_range);
+
+    // Growing past the initial index keeps every key reachable
+    OrderedTable big;
+    for (int i = 0; i < 1000; ++i) big["key" + std::to_string(i)] = var(i);
+    for (int i = 0; i < 1000; i += 3) big.erase("key" + std::to_string(i));
+    for (int i = 0; i < 1000; ++i) {
+        const var* found = big.find("key" + std::to_string(i));
+        CHECK((i % 3 == 0) == (found == nullptr));
+        if (found) CHECK(found->getInt() == i);
+    }
+    CHECK(big.keyAt(0) == "key1");
+
+    // Copies are independent and keep their index
+    OrderedTable copy = tbl;
+    copy.insert_or_assign("e", var(6));
+    copy.at("a") = var(0);
+    CHECK(tbl.size() == 4 && copy.size() == 5);
+    CHECK(tbl.at("a").getInt() == 20 && copy.at("a").getInt() == 0);
+    copy = tbl;
+    CHECK(copy.size() == 4 && copy.at("d").getInt() == 4);
+
+    OrderedTable moved = std::move(copy);
+    CHECK(moved.size() == 4 && moved.at("a").getInt() == 20);
+
+    // Inside a var, printing follows insertion order
+    var v(tbl);
+    var vCopy = v;
+    std::ostringstream text;
+    text << vCopy;
+    CHECK(text.str() == "{ \"a\": 20 \"b\": 3 \"d\": 4 \"c\": 5 }");
+
+    // var::find and forEachEntry treat every table kind alike
+    Table plain;
+    plain.emplace("a", var(20));
+    for (const var& keyed : { v, var(plain), var::toRecord(v) }) {
+        CHECK(keyed.isKeyed() && keyed.find("a")->getInt() == 20 && keyed.find("zz") == nullptr);
+        size_t visited = 0;
+        CHECK(!keyed.forEachEntry([&](std::string_view, const var&) { return ++visited < 1; }));
+        CHECK(visited == 1);
+    }
+    CHECK_THROWS(var(1).find("a"), std::runtime_error);
+    CHECK(var(2).toDouble() == 2.0 && var(2.5).toDouble() == 2.5 && !var("2").isNumber());
+    CHECK_THROWS(var("2").toDouble(), std::bad_variant_access);
+
+    // Values aliasing an entry stay valid while the table grows
+    OrderedTable aliased;
+    aliased.insert_or_assign("old", var(std::string(64, 'o')));
+    for (int i = 0; i < 40; ++i) {
+        aliased.insert_or_assign("copy" + std::to_string(i), aliased.at("old"));
+    }
+    for (int i = 0; i < 40; ++i) {
+        std::string key = "moved" + std::to_string(i);
+        aliased.insert_or_assign(key, std::move(aliased.at("copy" + std::to_string(i))));
+        CHECK(aliased.at(key).getString() == std::string(64, 'o'));
+    }
+    CHECK(aliased.size() == 81 && aliased.at("old").getString() == std::string(64, 'o'));
+
+    tbl.clear();
+    CHECK(tbl.empty() && tbl.find("a") == nullptr);
+    CHECK(tbl.insert_or_assign("x", var(1)) && tbl.at("x").getInt() == 1);
+    return 0;
+}
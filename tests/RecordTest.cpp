@@ -0,0 +1,118 @@
+#include "HighCPP.h"
+#include "Check.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    Record makePoint(int x, int y) {
+        Record rec;
+        rec.insert_or_assign("x", var(x));
+        rec.insert_or_assign("y", var(y));
+        return rec;
+    }
+}
+
+int main() {
+    // Records built alike share one shape, and the shape matches forKeys
+    Record a = makePoint(1, 2);
+    Record b = makePoint(3, 4);
+    CHECK(a.shape() == b.shape());
+    CHECK(a.shape() == Shape::forKeys({ "x", "y" }));
+    CHECK(a.shape() != Shape::forKeys({ "y", "x" }));
+    CHECK(a.at("y").getInt() == 2);
+    CHECK(b.find("z") == nullptr);
+
+    // Tables with the same keys convert into the same shape
+    var t1 = var::toRecord(var(OrderedTable{ { "x", var(5) }, { "y", var(6) } }));
+    CHECK(t1.getRecord().shape() == a.shape());
+
+    // Erase moves back onto the shared shape for the remaining keys
+    Record c = makePoint(7, 8);
+    CHECK(c.erase("x"));
+    CHECK(!c.erase("x"));
+    CHECK(c.shape() == Shape::forKeys({ "y" }));
+    CHECK(c.at("y").getInt() == 8);
+    CHECK_THROWS(Shape::forKeys({ "k", "k" }), std::invalid_argument);
+
+    // Shapes nobody uses are reclaimed, including whole chains of data-dependent keys
+    std::vector<std::weak_ptr<const Shape>> shapes;
+    {
+        std::vector<Record> records;
+        for (int i = 0; i < 1000; ++i) {
+            Record rec;
+            rec.insert_or_assign("id", var(i));
+            rec.insert_or_assign("key" + std::to_string(i), var(i));
+            shapes.push_back(rec.shape());
+            records.push_back(std::move(rec));
+        }
+        for (const auto& shape : shapes) CHECK(!shape.expired());
+    }
+    for (const auto& shape : shapes) CHECK(shape.expired());
+
+    // A reclaimed shape is rebuilt on demand
+    {
+        Record rec;
+        rec.insert_or_assign("id", var(1));
+        rec.insert_or_assign("key7", var(2));
+        CHECK(rec.shape()->keys() == (std::vector<std::string>{ "id", "key7" }));
+        CHECK(rec.at("key7").getInt() == 2);
+    }
+
+    // A property cache keeps its shape alive, so a new shape never aliases it
+    PropertyCache cache("y");
+    std::weak_ptr<const Shape> cachedShape;
+    {
+        var point = var::makeRecord(makePoint(1, 9));
+        CHECK(cache.find(point)->getInt() == 9);
+        cachedShape = point.getRecord().shape();
+    }
+    CHECK(!cachedShape.expired());
+    {
+        Record other;
+        other.insert_or_assign("y", var(3));
+        CHECK(cache.find(var::makeRecord(other))->getInt() == 3);
+    }
+
+    // The call-site cache macro takes string literals only
+    for (int i = 0; i < 3; ++i) CHECK(HIGHCPP_GET_ELEMENT(var::makeRecord(makePoint(i, 2 * i)), "y").getInt() == 2 * i);
+
+    // Wide records leave the transition tree; a record's own dictionary shape grows in place
+    Record wide;
+    const Shape* grown = nullptr;
+    for (int i = 0; i < 4000; ++i) {
+        wide.insert_or_assign("k" + std::to_string(i), var(i));
+        if (i == 64) grown = wide.shape().get();
+    }
+    CHECK(wide.shape()->isDictionary() && wide.shape().get() == grown);
+    CHECK(!Shape::forKeys({ "x", "y" })->isDictionary());
+    CHECK(wide.size() == 4000 && wide.at("k3999").getInt() == 3999 && wide.keyAt(64) == "k64");
+
+    // A shared dictionary shape is copied before it grows
+    Record wideCopy = wide;
+    wideCopy.insert_or_assign("extra", var(1));
+    CHECK(wideCopy.shape() != wide.shape());
+    CHECK(!wide.contains("extra") && wideCopy.at("extra").getInt() == 1 && wideCopy.at("k5").getInt() == 5);
+    var wideVar = var::toRecord(var::makeRecord(wide));
+    CHECK(var::len(wideVar) == 4000 && wideVar.getRecord().at("k1234").getInt() == 1234);
+    CHECK(wideVar.getRecord().shape()->keys() == wide.shape()->keys());
+
+    // Threads growing records along the same path agree on the shapes
+    std::vector<std::shared_ptr<const Shape>> perThread(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < perThread.size(); ++t) {
+        threads.emplace_back([&perThread, t] {
+            for (int i = 0; i < 1000; ++i) {
+                Record rec = makePoint(i, i);
+                rec.insert_or_assign("t", var(i));
+                if (i == 999) perThread[t] = rec.shape();
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (const auto& shape : perThread) CHECK(shape == perThread[0]);
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "HighCPP.h"
+#include "Schema.h"
+#include "Check.h"
+
+#include <string>
+
+namespace {
+    var table(std::initializer_list<std::pair<const VarString, var>> entries) {
+        return var::makeTable(Table(entries));
+    }
+
+    var array(std::initializer_list<var> values) {
+        return var::makeArray(Array(values));
+    }
+
+    bool hasViolation(const std::vector<SchemaViolation>& violations, const std::string& path, const std::string& message) {
+        for (const SchemaViolation& v : violations) {
+            if (v.path == path && v.message == message) return true;
+        }
+        return false;
+    }
+}
+
+int main() {
+    Schema schema = Schema::compile(table({
+        { "type", var("Table") },
+        { "required", array({ var("id"), var("items") }) },
+        { "additionalProperties", var(0) },
+        { "properties", table({
+            { "id", table({ { "type", var("Int") }, { "min", var(0) } }) },
+            { "name", table({ { "type", var("String") }, { "minLength", var(1) }, { "maxLength", var(5) } }) },
+            { "items", table({
+                { "type", var("Array") },
+                { "maxItems", var(3) },
+                { "items", table({
+                    { "type", var("Table") },
+                    { "required", array({ var("price") }) },
+                    { "properties", table({
+                        { "price", table({ { "type", var("Number") }, { "max", var(100) } }) },
+                        { "tags", table({ { "type", array({ var("Array"), var("Null") }) }, { "items", table({ { "type", var("String") } }) } }) } }) } }) } }) } }) } }));
+
+    var good = table({
+        { "id", var(7) },
+        { "name", var("abc") },
+        { "items", array({ table({ { "price", var(1.5) } }), table({ { "price", var(100) }, { "tags", array({ var("a") }) } }) }) } });
+    CHECK(schema.validate(good).empty());
+    CHECK(schema.isValid(good));
+
+    // Every violation is reported with the path to the offending value
+    var bad = table({
+        { "id", var(-1) },
+        { "name", var("too long") },
+        { "extra", var(1) },
+        { "items", array({
+            table({ { "price", var(101) } }),
+            table({ { "tags", array({ var("ok"), var(3) }) } }),
+            table({ { "price", var("free") }, { "tags", var() } }),
+            table({ { "price", var(1) } }) }) } });
+    std::vector<SchemaViolation> violations = schema.validate(bad);
+    CHECK(hasViolation(violations, "$.id", "value -1 is below minimum 0"));
+    CHECK(hasViolation(violations, "$.name", "length 8 is above maxLength 5"));
+    CHECK(hasViolation(violations, "$", "unexpected key 'extra'"));
+    CHECK(hasViolation(violations, "$.items", "4 items is above maxItems 3"));
+    CHECK(hasViolation(violations, "$.items[0].price", "value 101 is above maximum 100"));
+    CHECK(hasViolation(violations, "$.items[1]", "missing required key 'price'"));
+    CHECK(hasViolation(violations, "$.items[1].tags[1]", "expected String, got Int"));
+    CHECK(hasViolation(violations, "$.items[2].price", "expected Int or Double, got String"));
+    CHECK(violations.size() == 8);
+    CHECK(!schema.isValid(bad));
+
+    // Missing required keys and a wrong root type
+    std::vector<SchemaViolation> empty = schema.validate(var::makeTable(Table()));
+    CHECK(empty.size() == 2);
+    CHECK(hasViolation(empty, "$", "missing required key 'id'"));
+    CHECK(hasViolation(empty, "$", "missing required key 'items'"));
+    std::vector<SchemaViolation> wrongRoot = schema.validate(var(1));
+    CHECK(wrongRoot.size() == 1 && wrongRoot[0].path == "$" && wrongRoot[0].message == "expected Table, got Int");
+
+    // Keyed containers of every kind validate the same way
+    var ordered(OrderedTable{ { "id", var(1) }, { "items", array({}) } });
+    CHECK(schema.isValid(ordered));
+    CHECK(schema.isValid(var::toRecord(ordered)));
+
+    // Schema errors name the schema path
+    auto compileError = [](const var& description) -> std::string {
+        try {
+            Schema::compile(description);
+        }
+        catch (const std::invalid_argument& error) {
+            return error.what();
+        }
+        return "";
+    };
+    CHECK(compileError(var(1)) == "Schema error at $: schema is not a Table");
+    CHECK(compileError(table({ { "type", var("Integer") } })) == "Schema error at $: unknown type 'Integer'");
+    CHECK(compileError(table({ { "properties", table({ { "a", table({ { "min", var("x") } }) } }) } })) == "Schema error at $.a: 'min' is not a number");
+    CHECK(compileError(table({ { "items", table({ { "maxItems", var(-1) } }) } })) == "Schema error at $[]: 'maxItems' is not a non-negative Int");
+    CHECK(compileError(table({ { "required", var("id") } })) == "Schema error at $: 'required' is not an Array");
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "HighCPP.h"
+#include "Check.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    // Live and peak heap bytes, so the tests can bound what a walk allocates
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+    constexpr size_t kHeader = alignof(std::max_align_t);
+}
+
+void* operator new(size_t size) {
+    void* block = std::malloc(size + kHeader);
+    if (!block) throw std::bad_alloc();
+    *static_cast<size_t*>(block) = size;
+    liveBytes += size;
+    if (liveBytes > peakBytes) peakBytes = liveBytes;
+    return static_cast<char*>(block) + kHeader;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    void* block = static_cast<char*>(ptr) - kHeader;
+    liveBytes -= *static_cast<size_t*>(block);
+    std::free(block);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+namespace {
+    std::string printed(const var& value) {
+        std::ostringstream os;
+        os << value;
+        return os.str();
+    }
+
+    // Joins the chunks, checking every chunk but the last is exactly chunkSize bytes
+    std::string joined(const var& value, size_t chunkSize) {
+        std::vector<std::string> chunks;
+        for (std::string_view chunk : var::serialize(value, chunkSize)) chunks.emplace_back(chunk);
+        std::string text;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            CHECK(!chunks[i].empty());
+            if (i + 1 < chunks.size()) CHECK(chunks[i].size() == chunkSize);
+            CHECK(chunks[i].size() <= chunkSize);
+            text += chunks[i];
+        }
+        return text;
+    }
+}
+
+int main() {
+    Array items;
+    for (int i = 0; i < 200; ++i) items.emplace_back(i % 3 == 0 ? var(i * 0.25) : var("item" + std::to_string(i)));
+    Table inner;
+    inner.emplace("name", var("a string long enough to span several small chunks"));
+    inner.emplace("empty", var(Array()));
+    var doc(OrderedTable{
+        { "items", var(std::move(items)) },
+        { "inner", var(std::move(inner)) },
+        { "null", var() },
+        { "ordered", var(OrderedTable{ { "z", var(1) }, { "a", var(2) } }) },
+        { "pointer", var::makePointer(var(5)) } });
+
+    // Chunks join to exactly the printed text for any chunk size
+    const std::string expected = printed(doc);
+    for (size_t chunkSize : { size_t(1), size_t(3), size_t(64), size_t(4096), size_t(1) << 20 }) {
+        CHECK(joined(doc, chunkSize) == expected);
+    }
+    CHECK(joined(var(), 16) == printed(var()));
+    CHECK(joined(var(42), 1) == "42");
+    CHECK(joined(var(OrderedTable{ { "b", var(1) }, { "a", var(2) } }), 5) == "{ \"b\": 1 \"a\": 2 }");
+
+    // Abandoning the generator after the first chunk is fine
+    auto generator = var::serialize(doc, 8);
+    auto it = generator.begin();
+    CHECK(it != generator.end() && (*it).size() == 8);
+
+    // Deep trees stream without recursion
+    var deep;
+    for (int i = 0; i < 200000; ++i) {
+        Array wrapper;
+        wrapper.emplace_back(std::move(deep));
+        deep = var(std::move(wrapper));
+    }
+    size_t total = 0;
+    for (std::string_view chunk : var::serialize(deep, 4096)) total += chunk.size();
+    CHECK(total == 200000u * 4 + 4);
+
+    // Wide trees stream in memory proportional to depth, not to the number of elements
+    var wide(Array(200000, var(Array{ var(1), var(2) })));
+    size_t before = liveBytes;
+    peakBytes = liveBytes;
+    total = 0;
+    for (std::string_view chunk : var::serialize(wide, 4096)) total += chunk.size();
+    CHECK(total == 200000u * 8 + 3);
+    CHECK(peakBytes - before < 64 * 1024);
+
+    std::ostream discard(nullptr); // Writes nothing, but the walk still visits every node
+    before = liveBytes;
+    peakBytes = liveBytes;
+    discard << wide;
+    CHECK(peakBytes - before < 64 * 1024);
+
+    // A locked WeakPointer target is released once it has been written
+    auto target = std::make_shared<var>(5);
+    var weak(Array{ var(std::weak_ptr<var>(target)), var(1) });
+    std::string text;
+    for (std::string_view chunk : var::serialize(weak, 1)) {
+        text += chunk;
+        if (text == "[ WeakPointer(5) ") CHECK(target.use_count() == 1);
+    }
+    CHECK(text == "[ WeakPointer(5) 1 ]");
+
+    CHECK_THROWS(var::serialize(doc, 0), std::invalid_argument);
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "HighCPP.h"
+#include "Snapshot.h"
+#include "Check.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+int main() {
+    // Reader-side and writer-side state sit on separate cache lines
+    CHECK(alignof(SnapshotPublisher) >= 64);
+    CHECK(sizeof(SnapshotPublisher) >= 128);
+
+    SnapshotPublisher config(var(1));
+    SnapshotPublisher::Reader reader = config.reader();
+    {
+        auto snapshot = reader.read();
+        CHECK(snapshot->getInt() == 1);
+
+        // A pinned snapshot survives being replaced, and nested reads see the new one
+        config.publish(var(2));
+        CHECK(snapshot->getInt() == 1);
+        CHECK(config.retiredCount() == 1);
+        CHECK(config.collect() == 0);
+        {
+            auto nested = reader.read();
+            CHECK(nested->getInt() == 2);
+        }
+        CHECK(config.retiredCount() == 1);
+    }
+
+    // Once the reader leaves, retired snapshots are reclaimed
+    CHECK(config.collect() == 1);
+    CHECK(config.retiredCount() == 0);
+
+    // An idle reader holds nothing back; publish collects on its own
+    config.publish(var(3));
+    config.publish(var(4));
+    CHECK(config.retiredCount() == 0);
+    CHECK(reader.read()->getInt() == 4);
+
+    // Snapshots are only held back by readers that entered before they were retired
+    SnapshotPublisher::Reader other = config.reader();
+    {
+        auto old = other.read();
+        config.publish(var(5));
+        auto fresh = reader.read();
+        config.publish(var(6));
+        CHECK(config.retiredCount() == 2);
+        CHECK(old->getInt() == 4 && fresh->getInt() == 5);
+    }
+    CHECK(config.collect() == 2);
+
+    // A moved Reader keeps its slot; released slots are reused
+    {
+        SnapshotPublisher::Reader moved = std::move(other);
+        CHECK(moved.read()->getInt() == 6);
+    }
+    SnapshotPublisher::Reader reused = config.reader();
+    CHECK(reused.read()->getInt() == 6);
+
+    // Concurrent readers always see a whole published value
+    std::atomic<bool> stop{ false };
+    std::atomic<bool> torn{ false };
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&] {
+            SnapshotPublisher::Reader local = config.reader();
+            while (!stop.load()) {
+                auto snapshot = local.read();
+                if (!snapshot->isArray()) continue;
+                const Array& values = snapshot->getArray();
+                for (const var& value : values) {
+                    if (value.getInt() != values[0].getInt()) torn = true;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 2000; ++i) config.publish(var(Array(8, var(i))));
+    stop = true;
+    for (auto& thread : readers) thread.join();
+    CHECK(!torn);
+    config.collect();
+    CHECK(config.retiredCount() == 0);
+
+    return 0;
+}
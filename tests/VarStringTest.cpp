@@ -0,0 +1,120 @@
+#include "HighCPP.h"
+#include "Check.h"
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// Conversions to std::string copy, so they must be asked for
+static_assert(!std::is_convertible_v<VarString, std::string>);
+static_assert(std::is_constructible_v<std::string, VarString>);
+static_assert(std::is_convertible_v<VarString, std::string_view>);
+
+// var strings are immutable; there is no mutable accessor
+static_assert(std::is_same_v<decltype(std::declval<var&>().getString()), const VarString&>);
+
+int main() {
+    CHECK(sizeof(VarString) == 16);
+
+    const std::string fifteen(15, 'a');
+    const std::string sixteen(16, 'b');
+
+    // 15 characters still fit inline, 16 go to a shared buffer
+    VarString inlineText(fifteen);
+    VarString heapText(sixteen);
+    CHECK(inlineText.isInline());
+    CHECK(!heapText.isInline());
+    CHECK(inlineText.size() == 15 && inlineText == fifteen);
+    CHECK(heapText.size() == 16 && heapText == sixteen);
+    CHECK(inlineText.c_str()[15] == '\0');
+    CHECK(heapText.c_str()[16] == '\0');
+    CHECK(VarString().empty() && VarString().isInline());
+
+    // The hash matches the characters whether cached or not
+    CHECK(inlineText.hash() == std::hash<std::string_view>()(fifteen));
+    CHECK(heapText.hash() == std::hash<std::string_view>()(sixteen));
+
+    // Heap strings hash lazily; equality is right before and after either side is hashed
+    const std::string other = sixteen.substr(0, 15) + "c";
+    VarString first(sixteen), second(sixteen), third(other);
+    CHECK(first == second && !(first == third));
+    CHECK(first.hash() == heapText.hash() && third.hash() == std::hash<std::string_view>()(other));
+    CHECK(first == second && !(first == third) && !(second == third));
+    CHECK(second.hash() == first.hash() && first == second);
+    CHECK(VarString::concat(sixteen, "x").hash() == std::hash<std::string_view>()(sixteen + "x"));
+
+    // Copies share a heap buffer and release it when they go away
+    {
+        VarString copy = heapText;
+        CHECK(copy.data() == heapText.data());
+        CHECK(heapText.useCount() == 2);
+    }
+    CHECK(heapText.useCount() == 1);
+    CHECK(inlineText.useCount() == 1);
+
+    // Self-assignment keeps the value and the count
+    VarString self = heapText;
+    VarString& alias = self;
+    self = alias;
+    CHECK(self == sixteen && heapText.useCount() == 2);
+    self = std::move(alias);
+    CHECK(self == sixteen && heapText.useCount() == 2);
+    VarString smallSelf("tiny");
+    VarString& smallAlias = smallSelf;
+    smallSelf = smallAlias;
+    CHECK(smallSelf == "tiny");
+
+    // Moved-from strings are empty and usable; moving a heap string takes its reference
+    VarString moved(std::move(self));
+    CHECK(self.empty() && self.isInline());
+    CHECK(moved == sixteen && heapText.useCount() == 2);
+    self = moved;
+    CHECK(self == sixteen && heapText.useCount() == 3);
+    VarString target("old value");
+    target = std::move(moved);
+    CHECK(target == sixteen && moved.empty() && heapText.useCount() == 3);
+
+    // Assigning across the boundary in both directions
+    VarString changing(fifteen);
+    changing = heapText;
+    CHECK(!changing.isInline() && changing == sixteen);
+    changing = inlineText;
+    CHECK(changing.isInline() && changing == fifteen && heapText.useCount() == 3);
+
+    // concat lands inline up to 15 characters and on the heap from 16
+    VarString seven = VarString::concat("abc", "defg");
+    VarString atLimit = VarString::concat("abcdefg", "hijklmno");
+    VarString overLimit = VarString::concat("abcdefgh", "ijklmnop");
+    CHECK(seven.isInline() && seven == "abcdefg");
+    CHECK(atLimit.isInline() && atLimit == "abcdefghijklmno");
+    CHECK(!overLimit.isInline() && overLimit == "abcdefghijklmnop");
+    CHECK(overLimit.hash() == std::hash<std::string_view>()("abcdefghijklmnop"));
+    CHECK(VarString::concat("", sixteen) == heapText);
+    CHECK(VarString::concat(fifteen, "") == inlineText);
+    CHECK(VarString::concat("", "").empty());
+
+    // Equal text compares equal whatever the storage or buffer
+    CHECK(VarString(sixteen) == heapText);
+    CHECK(VarString("abcdefg") == seven);
+    CHECK(seven != overLimit);
+    CHECK((seven <=> overLimit) == std::strong_ordering::less);
+    CHECK(std::string(heapText) == sixteen);
+    CHECK(heapText.str() == sixteen);
+
+    // Tables look up String keys by view without building a VarString
+    Table tbl;
+    tbl.emplace(VarString(sixteen), var(1));
+    tbl.emplace(VarString("short"), var(2));
+    CHECK(tbl.find(std::string_view(sixteen)) != tbl.end());
+    CHECK(tbl.find("short")->second.getInt() == 2);
+    CHECK(tbl.find(std::string("missing")) == tbl.end());
+
+    // Records and ordered tables take the same views
+    var rec = var::toRecord(var(OrderedTable{ { sixteen, var(3) } }));
+    CHECK(rec.getRecord().find(heapText.view())->getInt() == 3);
+    OrderedTable ordered{ { "k", var(4) } };
+    CHECK(ordered.find(VarString("k"))->getInt() == 4);
+
+    return 0;
+}